@@ -10,6 +10,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <thread>
+#include <map>
+#include <vector>
 #include <sys/types.h>
 #if _WIN32
 #define read_portable(a, b, c) (recv(a, b, c, 0))
@@ -109,9 +111,34 @@ namespace pine
 			MsgUUID = 0xD,          /**< Returns the game UUID. */
 			MsgGameVersion = 0xE,   /**< Returns the game verion. */
 			MsgStatus = 0xF,        /**< Returns the emulator status. */
+			MsgReadBytes = 0x10,    /**< Read a range of memory. */
+			MsgWriteBytes = 0x11,   /**< Write a range of memory. */
+			MsgSubscribe = 0x12,    /**< Watch a range of memory, returns a subscription id. */
+			MsgUnsubscribe = 0x13,  /**< Stop watching a range of memory. */
+			MsgWaitChanges = 0x14,  /**< Wait for the next vblank and return the watched ranges that changed. */
 			MsgUnimplemented = 0xFF /**< Unimplemented IPC message. */
 		};
 
+		/**
+		 * Memory range watched by the client.
+		 * data holds the contents last sent to the client.
+		 */
+		struct Subscription
+		{
+			u32 addr{};
+			u32 size{};
+			bool sent{};
+			std::vector<char> data;
+		};
+
+		/**
+		 * Subscriptions of the connected client, by id.
+		 * Cleared when a new client connects.
+		 */
+		std::map<u32, Subscription> m_subscriptions;
+		u32 m_subscription_id = 0;
+		usz m_subscribed_size = 0;
+
 		/**
 		 * IPC message buffer.
 		 * A list of all needed fields to store an IPC message.
@@ -319,6 +346,96 @@ namespace pine
 						return error();
 					break;
 				}
+				// format: XX YY YY YY YY SS SS SS SS
+				// reply: XX [SS bytes of memory]
+				case MsgReadBytes:
+				{
+					if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+						return error();
+					const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+					const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+					if (!SafetyChecks(buf_cnt, 8, ret_cnt, size, buf_size))
+						return error();
+					if (!Impl::read_bytes(a, size, &ret_buffer[ret_cnt]))
+						return error();
+					ret_cnt += size;
+					buf_cnt += 8;
+					break;
+				}
+				// format: XX YY YY YY YY SS SS SS SS [SS bytes of data]
+				case MsgWriteBytes:
+				{
+					if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+						return error();
+					const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+					const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+					if (!SafetyChecks(buf_cnt, 8 + usz{size}, ret_cnt, 0, buf_size))
+						return error();
+					if (!Impl::write_bytes(a, size, &buf[buf_cnt + 8]))
+						return error();
+					buf_cnt += 8 + usz{size};
+					break;
+				}
+				// format: XX YY YY YY YY SS SS SS SS
+				// reply: XX II II II II (subscription id)
+				case MsgSubscribe:
+				{
+					if (!SafetyChecks(buf_cnt, 8, ret_cnt, 4, buf_size))
+						return error();
+					const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+					const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+					// All the ranges must fit in one MsgWaitChanges reply
+					if (!size || m_subscribed_size + 4 + size > MAX_IPC_RETURN_SIZE - 9 || !Impl::check_addr(a, vm::page_readable, size))
+						return error();
+					const u32 id = ++m_subscription_id;
+					m_subscriptions.emplace(id, Subscription{ a, size, false, std::vector<char>(size) });
+					m_subscribed_size += 4 + usz{size};
+					ToArray(ret_buffer, id, ret_cnt);
+					ret_cnt += 4;
+					buf_cnt += 8;
+					break;
+				}
+				// format: XX II II II II
+				case MsgUnsubscribe:
+				{
+					if (!SafetyChecks(buf_cnt, 4, ret_cnt, 0, buf_size))
+						return error();
+					const auto found = m_subscriptions.find(FromArray<u32>(&buf[buf_cnt], 0));
+					if (found == m_subscriptions.end())
+						return error();
+					m_subscribed_size -= 4 + usz{found->second.size};
+					m_subscriptions.erase(found);
+					buf_cnt += 4;
+					break;
+				}
+				// format: XX
+				// reply: XX NN NN NN NN (count) [II II II II (subscription id) [size bytes of memory]] * count
+				// Every range is reported after its subscription, then only when its contents changed
+				case MsgWaitChanges:
+				{
+					if (!SafetyChecks(buf_cnt, 0, ret_cnt, 4 + m_subscribed_size, buf_size))
+						return error();
+					Impl::wait_vblank();
+					const usz count_pos = ret_cnt;
+					u32 count = 0;
+					ret_cnt += 4;
+					for (auto& [id, sub] : m_subscriptions)
+					{
+						// Read in place, the range is only kept in the reply if it changed
+						char* const data = &ret_buffer[ret_cnt + 4];
+						if (!Impl::read_bytes(sub.addr, sub.size, data))
+							continue;
+						if (sub.sent && memcmp(data, sub.data.data(), sub.size) == 0)
+							continue;
+						memcpy(sub.data.data(), data, sub.size);
+						sub.sent = true;
+						ToArray(ret_buffer, id, ret_cnt);
+						ret_cnt += 4 + usz{sub.size};
+						count++;
+					}
+					ToArray(ret_buffer, count, count_pos);
+					break;
+				}
 				default:
 				{
 					return error();
@@ -374,6 +491,10 @@ namespace pine
 					return false;
 				}
 			}
+
+			// Subscriptions belong to the previous client
+			m_subscriptions.clear();
+			m_subscribed_size = 0;
 			return true;
 		}
 
@@ -0,0 +1,536 @@
+#include "stdafx.h"
+#include "async_io.h"
+#include "Thread.h"
+#include "lockless.h"
+#include "mutex.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <atomic>
+#include <thread>
+#ifdef IORING_FEAT_FAST_POLL
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+LOG_CHANNEL(aio_log, "AIO");
+
+bool fs::is_native_handle(native_handle handle)
+{
+#ifdef _WIN32
+	return handle != INVALID_HANDLE_VALUE;
+#else
+	return handle != -1;
+#endif
+}
+
+u64 fs::native_transfer(native_handle handle, u64 offset, void* data, u64 size, bool is_write, bool* failed)
+{
+	u64 result = 0;
+	bool error = false;
+
+	if (!is_native_handle(handle))
+	{
+		if (failed)
+			*failed = size != 0;
+
+		return 0;
+	}
+
+#ifdef _WIN32
+	while (result < size)
+	{
+		const DWORD block = static_cast<DWORD>(std::min<u64>(size - result, DWORD{umax} & -4096));
+
+		DWORD ntransferred = 0;
+		OVERLAPPED ovl{};
+		ovl.Offset = DWORD(offset + result);
+		ovl.OffsetHigh = DWORD((offset + result) >> 32);
+
+		const BOOL ok = is_write
+			? WriteFile(handle, static_cast<const u8*>(data) + result, block, &ntransferred, &ovl)
+			: ReadFile(handle, static_cast<u8*>(data) + result, block, &ntransferred, &ovl);
+
+		result += ntransferred;
+
+		if (!ok || ntransferred < block)
+		{
+			// Reads past the end of the file fail with ERROR_HANDLE_EOF
+			error = is_write || (!ok && GetLastError() != ERROR_HANDLE_EOF);
+			break;
+		}
+	}
+#else
+	while (result < size)
+	{
+		const auto r = is_write
+			? ::pwrite(handle, static_cast<const u8*>(data) + result, size - result, offset + result)
+			: ::pread(handle, static_cast<u8*>(data) + result, size - result, offset + result);
+
+		if (r < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (r <= 0)
+		{
+			// EOF, or EFAULT on inaccessible memory
+			error = r < 0 || is_write;
+			break;
+		}
+
+		result += r;
+	}
+#endif
+
+	if (failed)
+		*failed = error;
+
+	return result;
+}
+
+u64 fs::aio_engine::transfer(native_handle handle, u64 offset, void* data, u64 size, bool is_write, u64 chunk_size)
+{
+	const u64 count = chunk_size ? (size + chunk_size - 1) / chunk_size : 1;
+
+	if (count <= 1)
+	{
+		return native_transfer(handle, offset, data, size, is_write);
+	}
+
+	struct transfer_state
+	{
+		std::vector<u64> done;
+		atomic_t<u64> pending;
+	};
+
+	// Shared with the callbacks so that it outlives the last notification
+	const auto state = std::make_shared<transfer_state>();
+	state->done.resize(count);
+	state->pending = count;
+
+	for (u64 i = 0; i < count; i++)
+	{
+		aio_request req;
+		req.handle = handle;
+		req.offset = offset + i * chunk_size;
+		req.data = static_cast<u8*>(data) + i * chunk_size;
+		req.size = std::min<u64>(chunk_size, size - i * chunk_size);
+		req.is_write = is_write;
+		req.on_complete = [state, i](u64 transferred, bool)
+		{
+			state->done[i] = transferred;
+
+			if (--state->pending == 0)
+			{
+				state->pending.notify_one();
+			}
+		};
+
+		submit(std::move(req));
+	}
+
+	while (const u64 pending = state->pending)
+	{
+		state->pending.wait(pending);
+	}
+
+	u64 result = 0;
+
+	for (u64 i = 0; i < count; i++)
+	{
+		result += state->done[i];
+
+		if (state->done[i] < std::min<u64>(chunk_size, size - i * chunk_size))
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
+namespace fs
+{
+	// Fallback engine: blocking transfers on a group of worker threads
+	class thread_pool_aio_engine final : public aio_engine
+	{
+		struct worker
+		{
+			lf_queue<aio_request> queue;
+
+			static void execute(aio_request& req)
+			{
+				bool failed = false;
+				const u64 done = native_transfer(req.handle, req.offset, req.data, req.size, req.is_write, &failed);
+
+				req.on_complete(done, !failed);
+			}
+
+			void operator()()
+			{
+				while (thread_ctrl::state() != thread_state::aborting)
+				{
+					for (auto&& req : queue.pop_all())
+					{
+						execute(req);
+					}
+
+					thread_ctrl::wait_on(queue, nullptr);
+				}
+
+				// Complete whatever was queued before shutdown
+				for (auto&& req : queue.pop_all())
+				{
+					execute(req);
+				}
+			}
+		};
+
+		named_thread_group<worker> m_workers;
+		atomic_t<u32> m_next = 0;
+
+	public:
+		thread_pool_aio_engine(u32 worker_count)
+			: m_workers("FS AIO Worker ", std::max<u32>(worker_count, 1))
+		{
+		}
+
+		void submit(aio_request&& req) override
+		{
+			const u32 index = m_next++ % m_workers.size();
+			(m_workers.begin() + index)->queue.push(std::move(req));
+		}
+
+		std::string_view get_name() const override
+		{
+			return "thread pool";
+		}
+	};
+
+#ifdef HAVE_IO_URING
+	// io_uring engine, the kernel executes requests and a single reaper thread dispatches completions
+	class io_uring_aio_engine final : public aio_engine
+	{
+		struct operation
+		{
+			aio_request req;
+			u64 done = 0;
+		};
+
+		struct reaper
+		{
+			io_uring_aio_engine* engine;
+
+			void operator()()
+			{
+				engine->reap();
+			}
+		};
+
+		// Largest transfer submitted at once (the kernel takes a 32-bit length)
+		static constexpr u64 max_sqe_size = 0x4000'0000;
+
+		int m_fd = -1;
+		u32 m_entries = 0;
+
+		void* m_sq_ring = MAP_FAILED;
+		usz m_sq_ring_size = 0;
+		void* m_cq_ring = MAP_FAILED;
+		usz m_cq_ring_size = 0;
+		io_uring_sqe* m_sqes = nullptr;
+		usz m_sqes_size = 0;
+
+		u32* m_sq_tail = nullptr;
+		u32 m_sq_mask = 0;
+		u32* m_sq_array = nullptr;
+		u32* m_cq_head = nullptr;
+		u32* m_cq_tail = nullptr;
+		u32 m_cq_mask = 0;
+		io_uring_cqe* m_cqes = nullptr;
+
+		shared_mutex m_submit_mutex;
+		atomic_t<u32> m_in_flight = 0;
+		std::unique_ptr<named_thread<reaper>> m_reaper;
+
+		static int enter(int fd, u32 to_submit, u32 min_complete, u32 flags)
+		{
+			return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+		}
+
+		template <typename T>
+		static T* ring_ptr(void* ring, u32 offset)
+		{
+			return reinterpret_cast<T*>(static_cast<u8*>(ring) + offset);
+		}
+
+		void push(operation* op, u8 opcode)
+		{
+			std::lock_guard lock(m_submit_mutex);
+
+			const u32 tail = *m_sq_tail;
+			const u32 index = tail & m_sq_mask;
+
+			io_uring_sqe& sqe = m_sqes[index];
+			std::memset(&sqe, 0, sizeof(sqe));
+			sqe.opcode = opcode;
+			sqe.user_data = reinterpret_cast<u64>(op);
+
+			if (op)
+			{
+				sqe.fd = op->req.handle;
+				sqe.off = op->req.offset + op->done;
+				sqe.addr = reinterpret_cast<u64>(static_cast<u8*>(op->req.data) + op->done);
+				sqe.len = static_cast<u32>(std::min<u64>(op->req.size - op->done, max_sqe_size));
+			}
+
+			m_sq_array[index] = index;
+			std::atomic_ref(*m_sq_tail).store(tail + 1, std::memory_order_release);
+
+			while (enter(m_fd, 1, 0, 0) < 0)
+			{
+				if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					fmt::throw_exception("io_uring_enter() failed (errno=%d)", errno);
+				}
+
+				std::this_thread::yield();
+			}
+		}
+
+		void complete(operation* op, bool ok)
+		{
+			op->req.on_complete(op->done, ok);
+			delete op;
+
+			// Wake up submitters waiting for a slot, or the destructor waiting for the drain
+			if (const u32 old = m_in_flight--; old == m_entries || old == 1)
+			{
+				m_in_flight.notify_all();
+			}
+		}
+
+		void reap()
+		{
+			while (true)
+			{
+				u32 head = *m_cq_head;
+				const u32 tail = std::atomic_ref(*m_cq_tail).load(std::memory_order_acquire);
+
+				if (head == tail)
+				{
+					// Block until at least one completion is available
+					enter(m_fd, 0, 1, IORING_ENTER_GETEVENTS);
+					continue;
+				}
+
+				bool stop = false;
+
+				for (; head != tail; head++)
+				{
+					const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+					const s32 res = cqe.res;
+					operation* const op = reinterpret_cast<operation*>(cqe.user_data);
+
+					// Release the slot before the callback can submit more work
+					std::atomic_ref(*m_cq_head).store(head + 1, std::memory_order_release);
+
+					if (!op)
+					{
+						stop = true;
+						continue;
+					}
+
+					if (res > 0)
+					{
+						op->done += res;
+
+						if (op->done < op->req.size)
+						{
+							// Partial transfer, queue the remainder
+							push(op, op->req.is_write ? IORING_OP_WRITE : IORING_OP_READ);
+							continue;
+						}
+					}
+
+					// res == 0 means EOF for reads, a write which makes no progress is an error
+					complete(op, res > 0 || (res == 0 && !op->req.is_write));
+				}
+
+				if (stop)
+				{
+					break;
+				}
+			}
+		}
+
+	public:
+		static std::unique_ptr<io_uring_aio_engine> create(u32 queue_depth)
+		{
+			auto engine = std::make_unique<io_uring_aio_engine>();
+			return engine->init(queue_depth) ? std::move(engine) : nullptr;
+		}
+
+		bool init(u32 queue_depth)
+		{
+			io_uring_params params{};
+			m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, queue_depth, &params));
+
+			if (m_fd < 0)
+			{
+				aio_log.notice("io_uring is not available (errno=%d)", errno);
+				return false;
+			}
+
+			if (!(params.features & IORING_FEAT_FAST_POLL))
+			{
+				// Kernel too old for IORING_OP_READ/WRITE
+				aio_log.notice("io_uring kernel support is too old (features=0x%x)", params.features);
+				return false;
+			}
+
+			m_entries = params.sq_entries;
+			m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+			m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+			{
+				m_sq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+			}
+
+			m_sq_ring = ::mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+
+			if (m_sq_ring == MAP_FAILED)
+			{
+				return false;
+			}
+
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+			{
+				m_cq_ring = m_sq_ring;
+			}
+			else
+			{
+				m_cq_ring = ::mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+
+				if (m_cq_ring == MAP_FAILED)
+				{
+					return false;
+				}
+			}
+
+			m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+			void* sqes = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+
+			if (sqes == MAP_FAILED)
+			{
+				return false;
+			}
+
+			m_sqes = static_cast<io_uring_sqe*>(sqes);
+			m_sq_tail = ring_ptr<u32>(m_sq_ring, params.sq_off.tail);
+			m_sq_mask = *ring_ptr<u32>(m_sq_ring, params.sq_off.ring_mask);
+			m_sq_array = ring_ptr<u32>(m_sq_ring, params.sq_off.array);
+			m_cq_head = ring_ptr<u32>(m_cq_ring, params.cq_off.head);
+			m_cq_tail = ring_ptr<u32>(m_cq_ring, params.cq_off.tail);
+			m_cq_mask = *ring_ptr<u32>(m_cq_ring, params.cq_off.ring_mask);
+			m_cqes = ring_ptr<io_uring_cqe>(m_cq_ring, params.cq_off.cqes);
+
+			m_reaper = std::make_unique<named_thread<reaper>>("FS AIO Reaper", reaper{this});
+			return true;
+		}
+
+		~io_uring_aio_engine() override
+		{
+			if (m_reaper)
+			{
+				// Drain, then wake the reaper up with a null request
+				while (const u32 in_flight = m_in_flight)
+				{
+					m_in_flight.wait(in_flight);
+				}
+
+				push(nullptr, IORING_OP_NOP);
+				m_reaper.reset();
+			}
+
+			if (m_sqes)
+			{
+				::munmap(m_sqes, m_sqes_size);
+			}
+
+			if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+			{
+				::munmap(m_cq_ring, m_cq_ring_size);
+			}
+
+			if (m_sq_ring != MAP_FAILED)
+			{
+				::munmap(m_sq_ring, m_sq_ring_size);
+			}
+
+			if (m_fd >= 0)
+			{
+				::close(m_fd);
+			}
+		}
+
+		void submit(aio_request&& req) override
+		{
+			if (!req.size)
+			{
+				req.on_complete(0, true);
+				return;
+			}
+
+			// Wait for a free slot, the completion queue must never overflow
+			while (!m_in_flight.fetch_op([&](u32& v)
+			{
+				if (v < m_entries)
+				{
+					v++;
+					return true;
+				}
+
+				return false;
+			}).second)
+			{
+				m_in_flight.wait(m_entries);
+			}
+
+			const bool is_write = req.is_write;
+			push(new operation{std::move(req)}, is_write ? IORING_OP_WRITE : IORING_OP_READ);
+		}
+
+		std::string_view get_name() const override
+		{
+			return "io_uring";
+		}
+	};
+#endif
+}
+
+std::unique_ptr<fs::aio_engine> fs::make_aio_engine(u32 queue_depth, u32 worker_count)
+{
+#ifdef HAVE_IO_URING
+	if (auto engine = io_uring_aio_engine::create(queue_depth))
+	{
+		aio_log.notice("Using io_uring asynchronous I/O (queue depth=%u)", queue_depth);
+		return engine;
+	}
+#else
+	static_cast<void>(queue_depth);
+#endif
+
+	aio_log.notice("Using thread pool asynchronous I/O (%u workers)", worker_count);
+	return std::make_unique<thread_pool_aio_engine>(worker_count);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "Utilities/File.h"
+
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace fs
+{
+	// Positional transfer between a native file handle and host memory
+	struct aio_request
+	{
+		native_handle handle{};
+		u64 offset = 0;
+		void* data = nullptr;
+		u64 size = 0;
+		bool is_write = false;
+
+		// Called on an engine thread once the request is done, with the amount of bytes transferred
+		// ok is false if the transfer stopped on an error (e.g. the destination memory became inaccessible)
+		// A read which stopped short at the end of the file is ok, a short write never is
+		std::function<void(u64 transferred, bool ok)> on_complete;
+	};
+
+	// Returns false for files without a host handle (e.g. memory streams or emulated views)
+	bool is_native_handle(native_handle handle);
+
+	// Blocking positional transfer which reports errors as a short count instead of throwing
+	// failed is set if the transfer stopped short for another reason than reading at the end of the file
+	u64 native_transfer(native_handle handle, u64 offset, void* data, u64 size, bool is_write, bool* failed = nullptr);
+
+	// Host asynchronous file I/O engine
+	// Requests are executed concurrently and may complete out of order
+	class aio_engine
+	{
+	public:
+		virtual ~aio_engine() = default;
+
+		// Queue a request
+		virtual void submit(aio_request&& req) = 0;
+
+		// Backend name
+		virtual std::string_view get_name() const = 0;
+
+		// Split a transfer into chunks executed concurrently, and wait for all of them
+		// Returns the amount of bytes transferred contiguously from the start
+		u64 transfer(native_handle handle, u64 offset, void* data, u64 size, bool is_write, u64 chunk_size = 0x40000);
+	};
+
+	// Create the best engine available: io_uring on Linux, a pool of blocking worker threads otherwise
+	std::unique_ptr<aio_engine> make_aio_engine(u32 queue_depth, u32 worker_count);
+}
@@ -8,9 +8,12 @@
 #include "util/types.hpp"
 #include "util/endian.hpp"
 #include "util/asm.hpp"
+#include "util/serialization.hpp"
 
 #include <charconv>
 
+#include "xxhash.h"
+
 LOG_CHANNEL(patch_log, "PAT");
 
 template <>
@@ -357,31 +360,38 @@ bool patch_engine::load(patch_map& patches_map, const std::string& path, std::st
 				}
 			}
 
-			// Skip this patch if a higher patch version already exists
-			if (container.patch_info_map.find(description) != container.patch_info_map.end())
-			{
-				bool ok;
-				const std::string& existing_version = container.patch_info_map[description].patch_version;
-				const bool version_is_bigger = utils::compare_versions(info.patch_version, existing_version, ok) > 0;
+			insert_patch_info(container, std::move(info), importing, log_messages);
+		}
+	}
 
-				if (!ok || !version_is_bigger)
-				{
-					patch_log.warning("A higher or equal patch version already exists ('%s' vs '%s') for %s: %s (in file %s)", info.patch_version, existing_version, main_key, description, path);
-					append_log_message(log_messages, fmt::format("A higher or equal patch version already exists ('%s' vs '%s') for %s: %s (in file %s)", info.patch_version, existing_version, main_key, description, path));
-					continue;
-				}
-				else if (!importing)
-				{
-					patch_log.warning("A lower patch version was found ('%s' vs '%s') for %s: %s (in file %s)", existing_version, info.patch_version, main_key, description,  container.patch_info_map[description].source_path);
-				}
-			}
+	return is_valid;
+}
+
+void patch_engine::insert_patch_info(patch_container& container, patch_info&& info, bool importing, std::stringstream* log_messages)
+{
+	const std::string& description = info.description;
+
+	// Skip this patch if a higher patch version already exists
+	if (container.patch_info_map.find(description) != container.patch_info_map.end())
+	{
+		bool ok;
+		const std::string& existing_version = container.patch_info_map[description].patch_version;
+		const bool version_is_bigger = utils::compare_versions(info.patch_version, existing_version, ok) > 0;
 
-			// Insert patch information
-			container.patch_info_map[description] = info;
+		if (!ok || !version_is_bigger)
+		{
+			patch_log.warning("A higher or equal patch version already exists ('%s' vs '%s') for %s: %s (in file %s)", info.patch_version, existing_version, info.hash, description, info.source_path);
+			append_log_message(log_messages, fmt::format("A higher or equal patch version already exists ('%s' vs '%s') for %s: %s (in file %s)", info.patch_version, existing_version, info.hash, description, info.source_path));
+			return;
+		}
+		else if (!importing)
+		{
+			patch_log.warning("A lower patch version was found ('%s' vs '%s') for %s: %s (in file %s)", existing_version, info.patch_version, info.hash, description, container.patch_info_map[description].source_path);
 		}
 	}
 
-	return is_valid;
+	// Insert patch information
+	container.patch_info_map[description] = std::move(info);
 }
 
 patch_type patch_engine::get_patch_type(const std::string& text)
@@ -548,13 +558,289 @@ bool patch_engine::read_patch_node(patch_info& info, YAML::Node node, const YAML
 	return is_valid;
 }
 
+// Index of a patch file: the containers are stored serialized one after another, and the table of contents
+// lists the serials each of them is for, so only the patches of the booted title need to be deserialized
+namespace
+{
+	constexpr u64 patch_index_magic = "RPCSPIDX"_u64;
+	constexpr u32 patch_index_version = 1;
+
+	struct patch_index_entry
+	{
+		std::string key;
+		std::vector<std::string> serials;
+		u64 offset = 0;
+		u64 size = 0;
+
+		void operator()(utils::serial& ar)
+		{
+			ar(key, serials, offset, size);
+		}
+	};
+
+	struct patch_index
+	{
+		std::string engine_version;
+		u64 source_size = 0;
+		s64 source_mtime = 0;
+		u64 source_hash = 0;
+		bool is_valid = false;
+		std::vector<patch_index_entry> entries;
+		std::vector<u8> blob;
+
+		void operator()(utils::serial& ar)
+		{
+			ar(engine_version, source_size, source_mtime, source_hash, is_valid, entries, blob);
+		}
+	};
+
+	void serialize_patch_info(utils::serial& ar, patch_engine::patch_info& info)
+	{
+		ar(info.description, info.patch_version, info.patch_group, info.author, info.notes, info.source_path, info.hash, info.version);
+
+		u32 data_count = ::size32(info.data_list);
+		ar(data_count);
+
+		if (!ar.is_writing())
+		{
+			info.data_list.resize(data_count);
+		}
+
+		for (auto& data : info.data_list)
+		{
+			ar(data.type, data.offset, data.original_value, data.value.long_value);
+		}
+
+		// The enabled state is not stored, it comes from the patch config
+		u32 title_count = ::size32(info.titles);
+		ar(title_count);
+
+		if (ar.is_writing())
+		{
+			for (auto& [title, serials] : info.titles)
+			{
+				ar(title, ::size32(serials));
+
+				for (auto& [serial, app_versions] : serials)
+				{
+					ar(serial, ::size32(app_versions));
+
+					for (auto& [app_version, enabled] : app_versions)
+					{
+						ar(app_version);
+					}
+				}
+			}
+
+			return;
+		}
+
+		for (u32 i = 0; i < title_count; i++)
+		{
+			auto& serials = info.titles[ar.operator std::string()];
+
+			for (u32 j = 0, serial_count = ar; j < serial_count; j++)
+			{
+				auto& app_versions = serials[ar.operator std::string()];
+
+				for (u32 k = 0, version_count = ar; k < version_count; k++)
+				{
+					app_versions.emplace(ar.operator std::string(), false);
+				}
+			}
+		}
+	}
+
+	std::string get_patch_index_path(const std::string& path)
+	{
+		return fs::get_cache_dir() + "patches/" + path.substr(path.find_last_of("/\\") + 1) + ".idx";
+	}
+
+	bool load_patch_index(const std::string& index_path, patch_index& index)
+	{
+		const fs::file file(index_path);
+
+		if (!file || file.size() < sizeof(u64) * 2)
+		{
+			return false;
+		}
+
+		std::vector<u8> data = file.to_vector<u8>();
+
+		if (read_from_ptr<u64>(data) != patch_index_magic || read_from_ptr<u64>(data, sizeof(u64)) != XXH64(data.data() + 16, data.size() - 16, 0))
+		{
+			patch_log.warning("Ignoring invalid patch index %s", index_path);
+			return false;
+		}
+
+		data.erase(data.begin(), data.begin() + 16);
+
+		utils::serial ar;
+		ar.set_reading_state(std::move(data));
+
+		if (ar.operator u32() != patch_index_version)
+		{
+			return false;
+		}
+
+		ar(index);
+		return index.engine_version == patch_engine_version;
+	}
+
+	void save_patch_index(const std::string& index_path, patch_index& index)
+	{
+		utils::serial ar;
+		ar(patch_index_magic, u64{0}, patch_index_version, index);
+
+		write_to_ptr<u64>(ar.data, sizeof(u64), XXH64(ar.data.data() + 16, ar.data.size() - 16, 0));
+
+		fs::pending_file file(index_path);
+
+		if (!fs::create_path(fs::get_parent_dir(index_path)) || !file.file || (file.file.write(ar.data), !file.commit()))
+		{
+			patch_log.error("Failed to save patch index %s (error=%s)", index_path, fs::g_tls_error);
+		}
+	}
+}
+
+bool patch_engine::load_indexed(patch_map& patches_map, const std::string& path, const std::string& title_id)
+{
+	fs::stat_t stat{};
+
+	if (!fs::stat(path, stat) || stat.is_directory)
+	{
+		// Do nothing
+		return true;
+	}
+
+	const std::string index_path = get_patch_index_path(path);
+
+	patch_index index{};
+	bool index_loaded = load_patch_index(index_path, index);
+
+	if (!index_loaded || index.source_size != stat.size || index.source_mtime != stat.mtime)
+	{
+		// Only the content matters, the modification time may have changed alone (e.g. after a copy)
+		const fs::file file(path);
+
+		if (!file)
+		{
+			return true;
+		}
+
+		const std::string content = file.to_string();
+		const u64 source_hash = XXH64(content.data(), content.size(), 0);
+
+		if (!index_loaded || index.source_hash != source_hash)
+		{
+			patch_log.notice("Building patch index for %s", path);
+
+			// Parse without the patch config, the enabled state is applied when loading the index
+			patch_map file_map;
+			index = {};
+			index.is_valid = load(file_map, path, content, true);
+			index.engine_version = patch_engine_version;
+			index.source_hash = source_hash;
+
+			utils::serial blob;
+
+			for (auto& [key, container] : file_map)
+			{
+				patch_index_entry entry{};
+				entry.key = key;
+				entry.offset = blob.data.size();
+
+				blob(container.hash, container.version, ::size32(container.patch_info_map));
+
+				for (auto& [description, info] : container.patch_info_map)
+				{
+					serialize_patch_info(blob, info);
+
+					for (const auto& [title, serials] : info.titles)
+					{
+						for (const auto& [serial, app_versions] : serials)
+						{
+							if (std::find(entry.serials.begin(), entry.serials.end(), serial) == entry.serials.end())
+							{
+								entry.serials.push_back(serial);
+							}
+						}
+					}
+				}
+
+				entry.size = blob.data.size() - entry.offset;
+				index.entries.push_back(std::move(entry));
+			}
+
+			index.blob = std::move(blob.data);
+		}
+
+		index.source_size = stat.size;
+		index.source_mtime = stat.mtime;
+		save_patch_index(index_path, index);
+	}
+
+	if (!index.is_valid)
+	{
+		patch_log.error("Patch file %s contains errors, some patches were skipped", path);
+	}
+
+	// Load patch config to determine which patches are enabled
+	patch_map patch_config = load_config();
+
+	usz count = 0;
+
+	for (const auto& entry : index.entries)
+	{
+		if (std::find_if(entry.serials.begin(), entry.serials.end(), [&](const std::string& serial) { return serial == title_id || serial == patch_key::all; }) == entry.serials.end())
+		{
+			continue;
+		}
+
+		utils::serial ar;
+		ar.set_reading_state(std::vector<u8>(index.blob.begin() + entry.offset, index.blob.begin() + entry.offset + entry.size));
+
+		const std::string hash = ar;
+		const std::string version = ar;
+
+		auto& container = patches_map[hash];
+		container.hash = hash;
+		container.version = version;
+
+		for (u32 i = 0, patch_count = ar; i < patch_count; i++)
+		{
+			patch_info info{};
+			serialize_patch_info(ar, info);
+
+			for (auto& [title, serials] : info.titles)
+			{
+				for (auto& [serial, app_versions] : serials)
+				{
+					for (auto& [app_version, enabled] : app_versions)
+					{
+						enabled = patch_config[hash].patch_info_map[info.description].titles[title][serial][app_version];
+					}
+				}
+			}
+
+			insert_patch_info(container, std::move(info), false, nullptr);
+			count++;
+		}
+	}
+
+	patch_log.notice("Loaded %u patches for %s from the index of %s", count, title_id.empty() ? "all titles" : title_id, path);
+	return index.is_valid;
+}
+
 void patch_engine::append_global_patches()
 {
+	const std::string& title_id = Emu.GetTitleID();
+
 	// Regular patch.yml
-	load(m_map, get_patches_path() + "patch.yml");
+	load_indexed(m_map, get_patches_path() + "patch.yml", title_id);
 
 	// Imported patch.yml
-	load(m_map, get_imported_patch_path());
+	load_indexed(m_map, get_imported_patch_path(), title_id);
 }
 
 void patch_engine::append_title_patches(const std::string& title_id)
@@ -565,7 +851,7 @@ void patch_engine::append_title_patches(const std::string& title_id)
 	}
 
 	// Regular patch.yml
-	load(m_map, get_patches_path() + title_id + "_patch.yml");
+	load_indexed(m_map, get_patches_path() + title_id + "_patch.yml", title_id);
 }
 
 void ppu_register_range(u32 addr, u32 size);
@@ -120,6 +120,12 @@ public:
 	// Load from file and append to specified patches map
 	static bool load(patch_map& patches, const std::string& path, std::string content = "", bool importing = false, std::stringstream* log_messages = nullptr);
 
+	// Load from file through its precompiled index (rebuilt when the file changes) and append the patches of a title
+	static bool load_indexed(patch_map& patches, const std::string& path, const std::string& title_id);
+
+	// Add a patch to a container unless a higher version of it already exists
+	static void insert_patch_info(patch_container& container, patch_info&& info, bool importing, std::stringstream* log_messages = nullptr);
+
 	// Read and add a patch node to the patch info
 	static bool read_patch_node(patch_info& info, YAML::Node node, const YAML::Node& root, std::stringstream* log_messages = nullptr);
 
@@ -0,0 +1,424 @@
+#include "stdafx.h"
+#include "job_system.h"
+#include "Thread.h"
+#include "mutex.h"
+
+#include "util/sysinfo.hpp"
+
+#include <bit>
+#include <deque>
+#include <optional>
+
+LOG_CHANNEL(jobs_log, "JOBS");
+
+namespace utils
+{
+	struct job_tls
+	{
+		// Queue index of the current pool worker
+		u32 worker = umax;
+
+		// Whether the thread occupies a slot of the budget, and for which class
+		bool has_slot = false;
+		job_class cls = job_class::foreground;
+	};
+
+	thread_local job_tls g_tls_job;
+
+	// Budget requested before the pool started (0 = default)
+	atomic_t<u32> g_job_budget_limit = 0;
+	atomic_t<bool> g_job_pool_started = false;
+
+	class job_pool
+	{
+		static constexpr u32 class_count = static_cast<u32>(job_class::count);
+
+		struct job
+		{
+			std::shared_ptr<job_batch> batch;
+			u32 index;
+		};
+
+		// One queue per worker, the owner takes its newest jobs while other workers steal the oldest
+		struct job_queue
+		{
+			shared_mutex mutex;
+			std::deque<job> jobs[class_count];
+		};
+
+		struct job_worker
+		{
+			job_pool* pool;
+
+			void operator()()
+			{
+				pool->run_worker();
+			}
+		};
+
+		// Budget state: the low 16 bits count occupied slots, then 16 bits per class count threads waiting for one
+		static constexpr u32 slot_bits = 16;
+		static constexpr u64 slot_mask = (u64{1} << slot_bits) - 1;
+
+		static constexpr u64 waiter(job_class cls)
+		{
+			return u64{1} << (slot_bits * (static_cast<u32>(cls) + 1));
+		}
+
+		static bool has_urgent_waiters(u64 state, job_class cls)
+		{
+			for (u32 c = 0; c < static_cast<u32>(cls); c++)
+			{
+				if ((state >> (slot_bits * (c + 1))) & slot_mask)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		static u32 compute_budget()
+		{
+			const u32 threads = std::max<u32>(utils::get_thread_count(), 1);
+			const u64 mask = thread_ctrl::get_affinity_mask(thread_class::general);
+			const u32 cores = mask == umax ? threads : std::popcount(mask);
+			const u32 limit = g_job_budget_limit ? +g_job_budget_limit : threads;
+
+			return std::clamp<u32>(cores, 1, std::min(threads, limit));
+		}
+
+		const u32 m_budget;
+		const std::unique_ptr<job_queue[]> m_queues;
+
+		atomic_t<u32> m_queued = 0;
+		atomic_t<u32> m_next_queue = 0;
+		atomic_t<u32> m_next_worker = 0;
+		atomic_t<u64> m_slots = 0;
+
+		named_thread_group<job_worker> m_workers;
+
+	public:
+		job_pool()
+			: m_budget(compute_budget())
+			, m_queues(std::make_unique<job_queue[]>(m_budget))
+			, m_workers("Job Worker ", m_budget, job_worker{this})
+		{
+			jobs_log.notice("Job system started with %u workers", m_budget);
+		}
+
+		job_pool(const job_pool&) = delete;
+
+		job_pool& operator=(const job_pool&) = delete;
+
+		static job_pool& get()
+		{
+			g_job_pool_started = true;
+
+			static job_pool s_pool;
+			return s_pool;
+		}
+
+		u32 budget() const
+		{
+			return m_budget;
+		}
+
+		void acquire(job_class cls)
+		{
+			bool queued = false;
+
+			while (true)
+			{
+				const u64 old = m_slots;
+
+				if ((old & slot_mask) < m_budget && !has_urgent_waiters(old, cls))
+				{
+					if (m_slots.compare_and_swap_test(old, old + 1 - (queued ? waiter(cls) : 0)))
+					{
+						if (queued)
+						{
+							// Less urgent waiters may be able to proceed now
+							m_slots.notify_all();
+						}
+
+						return;
+					}
+
+					continue;
+				}
+
+				if (!queued)
+				{
+					queued = m_slots.compare_and_swap_test(old, old + waiter(cls));
+					continue;
+				}
+
+				m_slots.wait(old);
+			}
+		}
+
+		void release()
+		{
+			m_slots -= 1;
+			m_slots.notify_all();
+		}
+
+		void yield()
+		{
+			auto& tls = g_tls_job;
+
+			if (!tls.has_slot)
+			{
+				return;
+			}
+
+			if (const u64 state = m_slots; (state & slot_mask) >= m_budget && has_urgent_waiters(state, tls.cls))
+			{
+				release();
+				acquire(tls.cls);
+			}
+		}
+
+		void push(const std::shared_ptr<job_batch>& batch, u32 count)
+		{
+			const u32 worker = g_tls_job.worker;
+			auto& queue = m_queues[worker != umax ? worker : m_next_queue++ % m_budget];
+			{
+				std::lock_guard lock(queue.mutex);
+
+				for (u32 i = 0; i < count; i++)
+				{
+					queue.jobs[static_cast<u32>(batch->m_class)].push_back(job{batch, i});
+				}
+
+				m_queued += count;
+			}
+
+			m_queued.notify_all();
+		}
+
+		// Take a job, optionally only from the given batch
+		std::optional<job> pop(const job_batch* only = nullptr)
+		{
+			if (!m_queued)
+			{
+				return {};
+			}
+
+			const u32 self = g_tls_job.worker;
+			const u32 start = self != umax ? self : 0;
+
+			// Most urgent class first, then own queue first
+			for (u32 c = 0; c < class_count; c++)
+			{
+				for (u32 i = 0; i < m_budget; i++)
+				{
+					const u32 index = (start + i) % m_budget;
+					auto& queue = m_queues[index];
+
+					std::lock_guard lock(queue.mutex);
+
+					auto& list = queue.jobs[c];
+
+					if (list.empty())
+					{
+						continue;
+					}
+
+					std::optional<job> result;
+
+					if (only)
+					{
+						const auto found = std::find_if(list.begin(), list.end(), [&](const job& j) { return j.batch.get() == only; });
+
+						if (found == list.end())
+						{
+							continue;
+						}
+
+						result = std::move(*found);
+						list.erase(found);
+					}
+					else if (index == self)
+					{
+						result = std::move(list.back());
+						list.pop_back();
+					}
+					else
+					{
+						result = std::move(list.front());
+						list.pop_front();
+					}
+
+					m_queued--;
+					return result;
+				}
+			}
+
+			return {};
+		}
+
+		void execute(job& j)
+		{
+			auto& tls = g_tls_job;
+			const job_tls old = tls;
+
+			// Nested jobs run on the slot of the job which waits for them
+			if (!old.has_slot)
+			{
+				acquire(j.batch->m_class);
+			}
+
+			tls.has_slot = true;
+			tls.cls = j.batch->m_class;
+
+			j.batch->m_func(j.index);
+
+			tls = old;
+
+			if (!old.has_slot)
+			{
+				release();
+			}
+
+			if (--j.batch->m_pending == 0)
+			{
+				j.batch->m_pending.notify_all();
+			}
+		}
+
+		void wait(job_batch& batch)
+		{
+			auto& tls = g_tls_job;
+
+			while (const u32 pending = batch.m_pending)
+			{
+				if (tls.worker != umax)
+				{
+					// Help instead of blocking the worker, but only with this batch:
+					// unrelated jobs could need locks held by the waiting job
+					if (auto j = pop(&batch))
+					{
+						execute(*j);
+						continue;
+					}
+				}
+
+				// Don't keep the slot while blocked
+				const bool had_slot = tls.has_slot;
+
+				if (had_slot)
+				{
+					tls.has_slot = false;
+					release();
+				}
+
+				batch.m_pending.wait(pending);
+
+				if (had_slot)
+				{
+					acquire(tls.cls);
+					tls.has_slot = true;
+				}
+			}
+		}
+
+		void run_worker()
+		{
+			g_tls_job.worker = m_next_worker++;
+
+			thread_ctrl::set_thread_affinity_mask(thread_ctrl::get_affinity_mask(thread_class::general));
+
+			while (thread_ctrl::state() != thread_state::aborting)
+			{
+				if (auto j = pop())
+				{
+					execute(*j);
+					continue;
+				}
+
+				thread_ctrl::wait_on(m_queued, 0);
+			}
+		}
+	};
+
+	job_batch::job_batch(job_class cls, u32 count, std::function<void(u32)> func)
+		: m_func(std::move(func))
+		, m_class(cls)
+		, m_pending(count)
+	{
+	}
+
+	void job_batch::wait()
+	{
+		job_pool::get().wait(*this);
+	}
+
+	std::shared_ptr<job_batch> start_jobs(job_class cls, u32 count, std::function<void(u32)> func)
+	{
+		if (const auto& tls = g_tls_job; tls.has_slot && cls < tls.cls)
+		{
+			// Don't let work spawned by less urgent work jump the queue
+			cls = tls.cls;
+		}
+
+		auto batch = std::make_shared<job_batch>(cls, count, std::move(func));
+
+		if (count)
+		{
+			job_pool::get().push(batch, count);
+		}
+
+		return batch;
+	}
+
+	void run_jobs(job_class cls, u32 count, std::function<void(u32)> func)
+	{
+		start_jobs(cls, count, std::move(func))->wait();
+	}
+
+	u32 get_job_budget()
+	{
+		return job_pool::get().budget();
+	}
+
+	bool set_job_budget(u32 budget)
+	{
+		if (g_job_pool_started)
+		{
+			jobs_log.error("Cannot change the budget after the job system started");
+			return false;
+		}
+
+		g_job_budget_limit = budget;
+		return true;
+	}
+
+	void job_yield()
+	{
+		job_pool::get().yield();
+	}
+
+	job_slot::job_slot(job_class cls)
+	{
+		auto& tls = g_tls_job;
+
+		if (!tls.has_slot)
+		{
+			job_pool::get().acquire(cls);
+			tls.has_slot = true;
+			tls.cls = cls;
+			m_owner = true;
+		}
+	}
+
+	job_slot::~job_slot()
+	{
+		if (m_owner)
+		{
+			g_tls_job.has_slot = false;
+			job_pool::get().release();
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "util/atomic.hpp"
+
+#include <functional>
+#include <memory>
+
+namespace utils
+{
+	// Priority classes of the shared job system, from the most to the least urgent
+	enum class job_class : u32
+	{
+		foreground, // Work the emulation is waiting for (e.g. compilation during boot or at runtime)
+		background, // Work which only has to finish eventually (e.g. building caches ahead of time)
+		io,         // Bulk file processing (e.g. package installation)
+
+		count
+	};
+
+	class job_pool;
+
+	// Group of jobs started together
+	class job_batch
+	{
+		friend class job_pool;
+
+		std::function<void(u32)> m_func;
+		job_class m_class;
+		atomic_t<u32> m_pending;
+
+	public:
+		job_batch(job_class cls, u32 count, std::function<void(u32)> func);
+
+		job_batch(const job_batch&) = delete;
+
+		job_batch& operator=(const job_batch&) = delete;
+
+		// Check whether all jobs have completed
+		bool done() const
+		{
+			return m_pending == 0;
+		}
+
+		// Wait for all jobs, executing other queued jobs meanwhile if called from a job
+		void wait();
+	};
+
+	// Run func(0) ... func(count - 1) as separate jobs on the process-wide worker pool
+	// Jobs started from another job never get a more urgent class than their parent
+	std::shared_ptr<job_batch> start_jobs(job_class cls, u32 count, std::function<void(u32)> func);
+
+	// Run jobs and wait for their completion
+	void run_jobs(job_class cls, u32 count, std::function<void(u32)> func);
+
+	// Number of jobs which may run concurrently in the process
+	u32 get_job_budget();
+
+	// Lower the budget, only possible before the first job is started
+	bool set_job_budget(u32 budget);
+
+	// Let jobs of more urgent classes take over the slot of the current job if they are waiting for one
+	// Long running jobs should call it between work items
+	void job_yield();
+
+	// Occupy a slot of the budget for some heavy work done on a dedicated thread (e.g. a compiler thread)
+	// Does nothing if the current thread already holds one, for example when it runs a job
+	class job_slot
+	{
+		bool m_owner = false;
+
+	public:
+		explicit job_slot(job_class cls);
+
+		job_slot(const job_slot&) = delete;
+
+		job_slot& operator=(const job_slot&) = delete;
+
+		~job_slot();
+	};
+}
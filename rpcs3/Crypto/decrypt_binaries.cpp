@@ -5,12 +5,195 @@
 #include "Emu/IdManager.h"
 #include "Emu/System.h"
 #include "Utilities/StrUtil.h"
+#include "Utilities/job_system.h"
+#include "Utilities/mutex.h"
 
 #include <charconv>
+#include <chrono>
 #include <iostream>
+#include <unordered_map>
 
 LOG_CHANNEL(dec_log, "DECRYPT");
 
+namespace
+{
+	// Max amount of file data held in memory by all workers (a bigger file is still processed alone)
+	constexpr u64 max_memory_in_flight = 1024 * 1024 * 1024;
+
+	struct decrypt_context
+	{
+		// Keys to try, the first one is no KLIC
+		std::vector<u128> klics{u128{}};
+
+		// Index of the key which worked for another file of the same directory (usually the same title)
+		std::unordered_map<std::string, usz> dir_keys;
+
+		// Files which need a KLIC from the user
+		std::vector<std::string> pending;
+
+		shared_mutex mutex;
+
+		atomic_t<u64> in_flight = 0;
+
+		atomic_t<u32> decrypted = 0;
+		atomic_t<u32> failed = 0;
+		atomic_t<u64> bytes_in = 0;
+		atomic_t<u64> bytes_out = 0;
+
+		// Serializes CLI output lines
+		shared_mutex cout_mutex;
+
+		void print(const std::string& line)
+		{
+			std::lock_guard lock(cout_mutex);
+			std::cout << line << std::endl; // For CLI
+		}
+
+		void reserve_memory(u64 size)
+		{
+			while (true)
+			{
+				const u64 old = in_flight;
+
+				if ((old == 0 || old + size <= max_memory_in_flight) && in_flight.compare_and_swap_test(old, old + size))
+				{
+					return;
+				}
+
+				in_flight.wait(old);
+			}
+		}
+
+		void release_memory(u64 size)
+		{
+			in_flight -= size;
+			in_flight.notify_all();
+		}
+	};
+
+	// Try a single key, the file is reopened every time because decryption consumes it
+	// Returns an empty file on failure, and sets invalid if the file is not encrypted in a known format
+	fs::file try_decrypt(const std::string& path, const u128& klic, bool no_klic, u32& file_magic, bool& invalid)
+	{
+		fs::file elf_file;
+
+		if (!elf_file.open(path) || !elf_file.read(file_magic))
+		{
+			file_magic = 0;
+		}
+
+		switch (file_magic)
+		{
+		case "SCE\0"_u32:
+		{
+			return decrypt_self(std::move(elf_file), no_klic ? nullptr : const_cast<u8*>(reinterpret_cast<const u8*>(&klic)));
+		}
+		case "NPD\0"_u32:
+		{
+			// EDAT / SDAT
+			u128 key = klic;
+			return DecryptEDAT(elf_file, path, no_klic ? 1 : 8, reinterpret_cast<u8*>(&key), true);
+		}
+		default:
+		{
+			invalid = true;
+			return {};
+		}
+		}
+	}
+
+	// Stream the decrypted data to the output file
+	void write_output(decrypt_context& ctx, const std::string& old_path, u32 file_magic, fs::file& elf_file)
+	{
+		const std::string exec_ext = fmt::to_lower(old_path).ends_with(".sprx") ? ".prx" : ".elf";
+		const std::string new_path = file_magic == "NPD\0"_u32 ? old_path + ".unedat" :
+			old_path.substr(0, old_path.find_last_of('.')) + exec_ext;
+
+		fs::file new_file{new_path, fs::rewrite};
+
+		if (!new_file)
+		{
+			ctx.failed++;
+			dec_log.error("Failed to create %s", new_path);
+			ctx.print("Failed to create " + new_path);
+			return;
+		}
+
+		std::vector<u8> buffer(0x100000);
+		u64 written = 0;
+
+		elf_file.seek(0);
+
+		while (const u64 read = elf_file.read(buffer.data(), buffer.size()))
+		{
+			written += new_file.write(buffer.data(), read);
+		}
+
+		ctx.decrypted++;
+		ctx.bytes_out += written;
+		dec_log.success("Decrypted %s -> %s", old_path, new_path);
+		ctx.print("Decrypted " + old_path + " -> " + new_path);
+	}
+
+	// Try the known keys, starting with the one which worked for the same directory
+	// Returns false if the file needs a KLIC from the user
+	bool decrypt_with_known_keys(decrypt_context& ctx, const std::string& path)
+	{
+		const std::string dir = fs::get_parent_dir(path);
+
+		std::vector<u128> klics;
+		usz first_key = umax;
+		{
+			reader_lock lock(ctx.mutex);
+
+			klics = ctx.klics;
+
+			if (const auto found = ctx.dir_keys.find(dir); found != ctx.dir_keys.end())
+			{
+				first_key = found->second;
+			}
+		}
+
+		for (usz i = 0; i < klics.size() + (first_key != umax); i++)
+		{
+			// Previously successful key first, then every key in order
+			const usz key_it = first_key != umax ? (i == 0 ? first_key : i - 1) : i;
+
+			if (i > 0 && key_it == first_key)
+			{
+				continue;
+			}
+
+			u32 file_magic = 0;
+			bool invalid = false;
+
+			fs::file elf_file = try_decrypt(path, klics[key_it], key_it == 0, file_magic, invalid);
+
+			if (invalid)
+			{
+				ctx.failed++;
+				dec_log.error("Failed to decrypt \"%s\".", path);
+				ctx.print("Failed to decrypt \"" + path + "\".");
+				return true;
+			}
+
+			if (elf_file)
+			{
+				if (key_it != first_key)
+				{
+					std::lock_guard lock(ctx.mutex);
+					ctx.dir_keys[dir] = key_it;
+				}
+
+				write_output(ctx, path, file_magic, elf_file);
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
 void decrypt_sprx_libraries(std::vector<std::string> modules, std::function<std::string(std::string old_path, std::string path, bool tried)> input_cb)
 {
 	if (modules.empty())
@@ -22,102 +205,83 @@ void decrypt_sprx_libraries(std::vector<std::string> modules, std::function<std:
 	dec_log.notice("Decrypting binaries...");
 	std::cout << "Decrypting binaries..." << std::endl; // For CLI
 
-	// Always start with no KLIC
-	std::vector<u128> klics{u128{}};
+	decrypt_context ctx;
 
 	if (const auto keys = g_fxo->try_get<loaded_npdrm_keys>())
 	{
 		// Second klic: get it from a running game
 		if (const u128 klic = keys->last_key())
 		{
-			klics.emplace_back(klic);
+			ctx.klics.emplace_back(klic);
 		}
 	}
 
 	// Try to use the key that has been for the current running ELF
-	klics.insert(klics.end(), Emu.klic.begin(), Emu.klic.end());
+	ctx.klics.insert(ctx.klics.end(), Emu.klic.begin(), Emu.klic.end());
 
-	for (const std::string& _module : modules)
+	const auto start_time = std::chrono::steady_clock::now();
+
+	// Decrypt with the known keys in parallel, the memory used by file data is bounded
+	atomic_t<usz> next = 0;
+
+	utils::run_jobs(utils::job_class::io, std::min<u32>(utils::get_job_budget(), ::size32(modules)), [&](u32)
 	{
-		const std::string old_path = _module;
+		for (usz i = next++; i < modules.size(); i = next++)
+		{
+			const std::string& path = modules[i];
 
-		fs::file elf_file;
+			fs::stat_t stat{};
+			const u64 size = fs::stat(path, stat) ? stat.size : 0;
 
-		bool tried = false;
-		bool invalid = false;
-		usz key_it = 0;
-		u32 file_magic{};
+			// Encrypted input and decrypted output are both held in memory
+			const u64 cost = std::min<u64>(size * 2, max_memory_in_flight);
 
-		while (true)
-		{
-			for (; key_it < klics.size(); key_it++)
-			{
-				if (!elf_file.open(old_path) || !elf_file.read(file_magic))
-				{
-					file_magic = 0;
-				}
+			ctx.reserve_memory(cost);
 
-				switch (file_magic)
-				{
-				case "SCE\0"_u32:
-				{
-					// First KLIC is no KLIC
-					elf_file = decrypt_self(std::move(elf_file), key_it != 0 ? reinterpret_cast<u8*>(&klics[key_it]) : nullptr);
+			ctx.bytes_in += size;
 
-					if (!elf_file)
-					{
-						// Try another key
-						continue;
-					}
+			if (!decrypt_with_known_keys(ctx, path))
+			{
+				std::lock_guard lock(ctx.mutex);
+				ctx.pending.emplace_back(path);
+			}
 
-					break;
-				}
-				case "NPD\0"_u32:
-				{
-					// EDAT / SDAT
-					elf_file = DecryptEDAT(elf_file, old_path, key_it != 0 ? 8 : 1, reinterpret_cast<u8*>(&klics[key_it]), true);
+			ctx.release_memory(cost);
+		}
+	});
 
-					if (!elf_file)
-					{
-						// Try another key
-						continue;
-					}
+	// Ask the user for the missing keys, one file at a time
+	std::sort(ctx.pending.begin(), ctx.pending.end());
 
-					break;
-				}
-				default:
-				{
-					invalid = true;
-					break;
-				}
-				}
+	auto& klics = ctx.klics;
+	const usz known_keys = klics.size();
 
-				if (invalid)
-				{
-					elf_file.close();
-				}
+	for (const std::string& old_path : ctx.pending)
+	{
+		bool tried = false;
 
-				break;
-			}
+		// Only keys entered by the user for previous files remain to be tried
+		usz key_it = known_keys;
 
-			if (elf_file)
+		while (true)
+		{
+			u32 file_magic{};
+			bool invalid = false;
+			fs::file elf_file;
+
+			for (; key_it < klics.size(); key_it++)
 			{
-				const std::string exec_ext = fmt::to_lower(_module).ends_with(".sprx") ? ".prx" : ".elf";
-				const std::string new_path = file_magic == "NPD\0"_u32 ? old_path + ".unedat" :
-					old_path.substr(0, old_path.find_last_of('.')) + exec_ext;
+				elf_file = try_decrypt(old_path, klics[key_it], false, file_magic, invalid);
 
-				if (fs::file new_file{new_path, fs::rewrite})
+				if (elf_file || invalid)
 				{
-					new_file.write(elf_file.to_string());
-					dec_log.success("Decrypted %s -> %s", old_path, new_path);
-					std::cout << "Decrypted " << old_path << " -> " << new_path << std::endl; // For CLI
-				}
-				else
-				{
-					dec_log.error("Failed to create %s", new_path);
-					std::cout << "Failed to create " << new_path << std::endl; // For CLI
+					break;
 				}
+			}
 
+			if (elf_file)
+			{
+				write_output(ctx, old_path, file_magic, elf_file);
 				break;
 			}
 
@@ -146,7 +310,8 @@ void decrypt_sprx_libraries(std::vector<std::string> modules, std::function<std:
 					klic = (u128{+hi} << 64) | +lo;
 
 					// Retry with specified KLIC
-					key_it -= +std::exchange(tried, true); // Rewind on second and above attempt
+					key_it = klics.size() - 1;
+					tried = true;
 					dec_log.notice("KLIC entered for %s: %s", filename, klic);
 					continue;
 				}
@@ -154,12 +319,20 @@ void decrypt_sprx_libraries(std::vector<std::string> modules, std::function<std:
 				dec_log.notice("User has cancelled entering KLIC.");
 			}
 
+			ctx.failed++;
 			dec_log.error("Failed to decrypt \"%s\".", old_path);
 			std::cout << "Failed to decrypt \"" << old_path << "\"." << std::endl; // For CLI
 			break;
 		}
 	}
 
-	dec_log.notice("Finished decrypting all binaries.");
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	const double mib = ctx.bytes_in / 1048576.;
+
+	const std::string summary = fmt::format("Decrypted %u of %u file(s) in %.2fs (%.1f MiB read, %.1f MiB written, %.1f MiB/s)",
+		+ctx.decrypted, modules.size(), seconds, mib, ctx.bytes_out / 1048576., seconds > 0 ? mib / seconds : 0.);
+
+	dec_log.notice("Finished decrypting all binaries. %s", summary);
 	std::cout << "Finished decrypting all binaries." << std::endl; // For CLI
+	std::cout << summary << std::endl; // For CLI
 }
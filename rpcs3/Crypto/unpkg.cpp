@@ -5,6 +5,7 @@
 #include "util/logs.hpp"
 #include "Utilities/StrUtil.h"
 #include "Utilities/Thread.h"
+#include "Utilities/job_system.h"
 #include "Utilities/mutex.h"
 #include "Emu/System.h"
 #include "Emu/system_utils.hpp"
@@ -1039,18 +1040,18 @@ package_error package_reader::extract_data(std::deque<package_reader>& readers,
 			}
 		}
 
-		reader.m_bufs.resize(std::min<usz>(utils::get_thread_count(), reader.m_install_entries.size()));
+		reader.m_bufs.resize(std::min<usz>(utils::get_job_budget(), reader.m_install_entries.size()));
 		reader.m_num_failures = error == package_error::no_error ? 0 : 1;
 
 		atomic_t<usz> thread_indexer = 0;
 
-		named_thread_group workers("PKG Installer "sv, std::max<u32>(::narrow<u32>(reader.m_bufs.size()), 1) - 1, [&]()
+		const auto workers = utils::start_jobs(utils::job_class::io, std::max<u32>(::narrow<u32>(reader.m_bufs.size()), 1) - 1, [&](u32)
 		{
 			reader.extract_worker(thread_key{thread_indexer++});
 		});
 
 		reader.extract_worker(thread_key{thread_indexer++});
-		workers.join();
+		workers->wait();
 
 		num_failures += reader.m_num_failures;
 
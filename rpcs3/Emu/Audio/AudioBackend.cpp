@@ -43,10 +43,7 @@ bool AudioBackend::get_convert_to_s16() const
 
 void AudioBackend::convert_to_s16(u32 cnt, const f32* src, void* dst)
 {
-	for (u32 i = 0; i < cnt; i++)
-	{
-		static_cast<s16*>(dst)[i] = static_cast<s16>(std::clamp(src[i] * 32768.5f, -32768.0f, 32767.0f));
-	}
+	audio::convert_to_s16(cnt, src, static_cast<s16*>(dst));
 }
 
 f32 AudioBackend::apply_volume(const VolumeParam& param, u32 sample_cnt, const f32* src, f32* dst)
@@ -92,18 +89,12 @@ f32 AudioBackend::apply_volume(const VolumeParam& param, u32 sample_cnt, const f
 
 void AudioBackend::apply_volume_static(f32 vol, u32 sample_cnt, const f32* src, f32* dst)
 {
-	for (u32 i = 0; i < sample_cnt; i++)
-	{
-		dst[i] = src[i] * vol;
-	}
+	audio::scale(sample_cnt, vol, src, dst);
 }
 
 void AudioBackend::normalize(u32 sample_cnt, const f32* src, f32* dst)
 {
-	for (u32 i = 0; i < sample_cnt; i++)
-	{
-		dst[i] = std::clamp<f32>(src[i], -1.0f, 1.0f);
-	}
+	audio::clamp(sample_cnt, src, dst);
 }
 
 std::pair<AudioChannelCnt, AudioChannelCnt> AudioBackend::get_channel_count_and_downmixer(u32 device_index)
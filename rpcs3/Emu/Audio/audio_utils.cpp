@@ -0,0 +1,510 @@
+#include "stdafx.h"
+#include "audio_utils.h"
+#include "AudioBackend.h"
+
+#include "util/sysinfo.hpp"
+
+#include <numbers>
+
+#if defined(ARCH_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) || !defined(__SSE2__)
+#define AVX2_FUNC
+#else
+#define AVX2_FUNC __attribute__((__target__("avx2")))
+#endif
+
+#if defined(__AVX2__)
+[[maybe_unused]] constexpr bool s_use_avx2 = true;
+#elif defined(ARCH_X64)
+[[maybe_unused]] const bool s_use_avx2 = utils::has_avx2();
+#else
+[[maybe_unused]] constexpr bool s_use_avx2 = false;
+#endif
+
+namespace
+{
+	// Same coefficients as the scalar code they replace
+	constexpr f32 s_backend_center_coef = std::numbers::sqrt2_v<f32> / 2;
+	constexpr f32 s_backend_surround_coef = std::numbers::sqrt2_v<f32> / 2;
+	constexpr f32 s_port_minus_3db = 0.707f; // value taken from https://www.dolby.com/us/en/technologies/a-guide-to-dolby-metadata.pdf
+
+	constexpr f32 s_s16_scale = 32768.5f;
+
+	s16 to_s16(f32 value)
+	{
+		return static_cast<s16>(std::clamp(value * s_s16_scale, -32768.0f, 32767.0f));
+	}
+
+	// Reference implementation of a single cellAudio port frame
+	template <u32 OutCh, AudioChannelCnt Mode>
+	void mix_port_frame_8(f32 m, const be_t<f32>* in, f32* out)
+	{
+		const f32 left       = in[0] * m;
+		const f32 right      = in[1] * m;
+		const f32 center     = in[2] * m;
+		const f32 low_freq   = in[3] * m;
+		const f32 side_left  = in[4] * m;
+		const f32 side_right = in[5] * m;
+		const f32 rear_left  = in[6] * m;
+		const f32 rear_right = in[7] * m;
+
+		if constexpr (Mode == AudioChannelCnt::STEREO)
+		{
+			// Don't mix in the lfe as per dolby specification and based on documentation
+			const f32 mid = center * 0.5f;
+			out[0] += left * s_port_minus_3db + mid + side_left * 0.5f + rear_left * 0.5f;
+			out[1] += right * s_port_minus_3db + mid + side_right * 0.5f + rear_right * 0.5f;
+		}
+		else
+		{
+			out[0] += left;
+			out[1] += right;
+
+			if constexpr (OutCh >= 6)
+			{
+				out[2] += center;
+				out[3] += low_freq;
+
+				if constexpr (Mode == AudioChannelCnt::SURROUND_5_1)
+				{
+					// With 7.1 output, [4] and [5] are the rear channels, so the side channels go to [6] and [7]
+					out[OutCh - 2] += side_left + rear_left;
+					out[OutCh - 1] += side_right + rear_right;
+				}
+				else if constexpr (OutCh == 6)
+				{
+					out[4] += side_left;
+					out[5] += side_right;
+				}
+				else
+				{
+					out[4] += rear_left;
+					out[5] += rear_right;
+					out[6] += side_left;
+					out[7] += side_right;
+				}
+			}
+		}
+	}
+
+#if defined(ARCH_X64)
+	// Load four big-endian floats
+	__m128 load_be_ps(const be_t<f32>* src)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+#if defined(__SSSE3__)
+		return _mm_castsi128_ps(_mm_shuffle_epi8(v, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)));
+#else
+		// Swap the 16-bit halves, then the bytes of each half
+		const __m128i w = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xb1), 0xb1);
+		return _mm_castsi128_ps(_mm_or_si128(_mm_slli_epi16(w, 8), _mm_srli_epi16(w, 8)));
+#endif
+	}
+
+	// out[0..1] += v[0..1]
+	void add_pair(f32* out, __m128 v)
+	{
+		const __m128 d = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(out));
+		_mm_storel_pi(reinterpret_cast<__m64*>(out), _mm_add_ps(d, v));
+	}
+
+	// out[0..3] += v
+	void add_quad(f32* out, __m128 v)
+	{
+		_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), v));
+	}
+
+	template <u32 OutCh, AudioChannelCnt Mode>
+	void mix_port_8_sse(u32 frame_cnt, f32 m, const be_t<f32>* src, f32* dst)
+	{
+		const __m128 vol = _mm_set1_ps(m);
+
+		for (u32 i = 0; i < frame_cnt; i++, src += 8, dst += OutCh)
+		{
+			// [L, R, C, LFE] and [SL, SR, RL, RR]
+			const __m128 lo = _mm_mul_ps(load_be_ps(src), vol);
+			const __m128 hi = _mm_mul_ps(load_be_ps(src + 4), vol);
+
+			if constexpr (Mode == AudioChannelCnt::STEREO)
+			{
+				// [SL + RL, SR + RR]
+				const __m128 surround = _mm_add_ps(hi, _mm_movehl_ps(hi, hi));
+				const __m128 mid = _mm_mul_ps(_mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 2, 2, 2)), _mm_set1_ps(0.5f));
+				const __m128 front = _mm_add_ps(_mm_mul_ps(lo, _mm_set1_ps(s_port_minus_3db)), mid);
+				add_pair(dst, _mm_add_ps(front, _mm_mul_ps(surround, _mm_set1_ps(0.5f))));
+			}
+			else if constexpr (OutCh == 2)
+			{
+				add_pair(dst, lo);
+			}
+			else
+			{
+				add_quad(dst, lo);
+
+				if constexpr (Mode == AudioChannelCnt::SURROUND_5_1)
+				{
+					add_pair(dst + OutCh - 2, _mm_add_ps(hi, _mm_movehl_ps(hi, hi)));
+				}
+				else if constexpr (OutCh == 6)
+				{
+					add_pair(dst + 4, hi);
+				}
+				else
+				{
+					// [RL, RR, SL, SR]
+					add_quad(dst + 4, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 0, 3, 2)));
+				}
+			}
+		}
+	}
+
+	template <u32 OutCh>
+	void mix_port_2_sse(u32 frame_cnt, f32 m, const be_t<f32>* src, f32* dst)
+	{
+		const __m128 vol = _mm_set1_ps(m);
+		u32 i = 0;
+
+		for (; i + 2 <= frame_cnt; i += 2)
+		{
+			const __m128 v = _mm_mul_ps(load_be_ps(src + i * 2), vol);
+
+			if constexpr (OutCh == 2)
+			{
+				add_quad(dst + i * 2, v);
+			}
+			else
+			{
+				add_pair(dst + i * OutCh, v);
+				add_pair(dst + (i + 1) * OutCh, _mm_movehl_ps(v, v));
+			}
+		}
+
+		for (; i < frame_cnt; i++)
+		{
+			dst[i * OutCh + 0] += src[i * 2 + 0] * m;
+			dst[i * OutCh + 1] += src[i * 2 + 1] * m;
+		}
+	}
+
+	AVX2_FUNC void mix_port_2_2_avx2(u32 frame_cnt, f32 m, const be_t<f32>* src, f32* dst)
+	{
+		const __m256 vol = _mm256_set1_ps(m);
+		const __m256i swap = _mm256_set_epi8(
+			12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+			12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+		const u32 sample_cnt = frame_cnt * 2;
+		u32 i = 0;
+
+		for (; i + 8 <= sample_cnt; i += 8)
+		{
+			const __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), swap);
+			_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_castsi256_ps(v), vol)));
+		}
+
+		for (; i < sample_cnt; i++)
+		{
+			dst[i] += src[i] * m;
+		}
+	}
+
+	AVX2_FUNC void scale_avx2(u32 sample_cnt, f32 vol, const f32* src, f32* dst)
+	{
+		const __m256 v = _mm256_set1_ps(vol);
+		u32 i = 0;
+
+		for (; i + 8 <= sample_cnt; i += 8)
+		{
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), v));
+		}
+
+		for (; i < sample_cnt; i++)
+		{
+			dst[i] = src[i] * vol;
+		}
+	}
+
+	AVX2_FUNC void clamp_avx2(u32 sample_cnt, const f32* src, f32* dst)
+	{
+		const __m256 lo = _mm256_set1_ps(-1.0f);
+		const __m256 hi = _mm256_set1_ps(1.0f);
+		u32 i = 0;
+
+		for (; i + 8 <= sample_cnt; i += 8)
+		{
+			_mm256_storeu_ps(dst + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo), hi));
+		}
+
+		for (; i < sample_cnt; i++)
+		{
+			dst[i] = std::clamp<f32>(src[i], -1.0f, 1.0f);
+		}
+	}
+
+	AVX2_FUNC void convert_to_s16_avx2(u32 sample_cnt, const f32* src, s16* dst)
+	{
+		const __m256 scale = _mm256_set1_ps(s_s16_scale);
+		const __m256 lo = _mm256_set1_ps(-32768.0f);
+		const __m256 hi = _mm256_set1_ps(32767.0f);
+		u32 i = 0;
+
+		// Both inputs are loaded before the store, so the conversion also works in place
+		for (; i + 16 <= sample_cnt; i += 16)
+		{
+			const __m256i a = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), lo), hi));
+			const __m256i b = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale), lo), hi));
+
+			// packs works on 128-bit lanes, restore the sample order
+			const __m256i r = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), r);
+		}
+
+		for (; i < sample_cnt; i++)
+		{
+			dst[i] = to_s16(src[i]);
+		}
+	}
+#endif
+}
+
+namespace audio
+{
+	void scale(u32 sample_cnt, f32 vol, const f32* src, f32* dst)
+	{
+		u32 i = 0;
+
+#if defined(ARCH_X64)
+		if (s_use_avx2)
+		{
+			return scale_avx2(sample_cnt, vol, src, dst);
+		}
+
+		const __m128 v = _mm_set1_ps(vol);
+
+		for (; i + 4 <= sample_cnt; i += 4)
+		{
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), v));
+		}
+#endif
+
+		for (; i < sample_cnt; i++)
+		{
+			dst[i] = src[i] * vol;
+		}
+	}
+
+	void clamp(u32 sample_cnt, const f32* src, f32* dst)
+	{
+		u32 i = 0;
+
+#if defined(ARCH_X64)
+		if (s_use_avx2)
+		{
+			return clamp_avx2(sample_cnt, src, dst);
+		}
+
+		const __m128 lo = _mm_set1_ps(-1.0f);
+		const __m128 hi = _mm_set1_ps(1.0f);
+
+		for (; i + 4 <= sample_cnt; i += 4)
+		{
+			_mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi));
+		}
+#endif
+
+		for (; i < sample_cnt; i++)
+		{
+			dst[i] = std::clamp<f32>(src[i], -1.0f, 1.0f);
+		}
+	}
+
+	void convert_to_s16(u32 sample_cnt, const f32* src, s16* dst)
+	{
+		u32 i = 0;
+
+#if defined(ARCH_X64)
+		if (s_use_avx2)
+		{
+			return convert_to_s16_avx2(sample_cnt, src, dst);
+		}
+
+		const __m128 scale = _mm_set1_ps(s_s16_scale);
+		const __m128 lo = _mm_set1_ps(-32768.0f);
+		const __m128 hi = _mm_set1_ps(32767.0f);
+
+		for (; i + 8 <= sample_cnt; i += 8)
+		{
+			const __m128i a = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi));
+			const __m128i b = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), lo), hi));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+		}
+#endif
+
+		for (; i < sample_cnt; i++)
+		{
+			dst[i] = to_s16(src[i]);
+		}
+	}
+
+	void downmix(u32 sample_cnt, AudioChannelCnt from, AudioChannelCnt to, const f32* src, f32* dst)
+	{
+		const u32 in_ch = static_cast<u32>(from);
+		const u32 out_ch = static_cast<u32>(to);
+		const u32 frame_cnt = sample_cnt / in_ch;
+
+		// Frames are processed in order and each one is fully loaded before its output is stored, which keeps in-place downmixing valid
+		u32 i = 0;
+
+#if defined(ARCH_X64)
+		const __m128 center_coef = _mm_set1_ps(s_backend_center_coef);
+		const __m128 surround_coef = _mm_set1_ps(s_backend_surround_coef);
+
+		if (from == AudioChannelCnt::SURROUND_7_1 && to == AudioChannelCnt::SURROUND_5_1)
+		{
+			for (; i < frame_cnt; i++)
+			{
+				// [L, R, C, LFE] and [RL, RR, SL, SR]
+				const __m128 lo = _mm_loadu_ps(src + i * 8);
+				const __m128 hi = _mm_loadu_ps(src + i * 8 + 4);
+				_mm_storeu_ps(dst + i * 6, lo);
+				_mm_storel_pi(reinterpret_cast<__m64*>(dst + i * 6 + 4), _mm_add_ps(hi, _mm_movehl_ps(hi, hi)));
+			}
+		}
+		else if (to == AudioChannelCnt::STEREO && (from == AudioChannelCnt::SURROUND_7_1 || from == AudioChannelCnt::SURROUND_5_1))
+		{
+			for (; i < frame_cnt; i++)
+			{
+				const f32* in = src + i * in_ch;
+
+				// [L, R, C, LFE]
+				const __m128 lo = _mm_loadu_ps(in);
+
+				// [SL, SR] for 5.1, [RL + SL, RR + SR] for 7.1
+				__m128 surround = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(in + 4));
+
+				if (from == AudioChannelCnt::SURROUND_7_1)
+				{
+					surround = _mm_add_ps(surround, _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(in + 6)));
+				}
+
+				const __m128 mid = _mm_mul_ps(_mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 2, 2, 2)), center_coef);
+				const __m128 r = _mm_add_ps(_mm_add_ps(lo, mid), _mm_mul_ps(surround, surround_coef));
+				_mm_storel_pi(reinterpret_cast<__m64*>(dst + i * 2), r);
+			}
+		}
+#endif
+
+		for (; i < frame_cnt; i++)
+		{
+			const f32* in = src + i * in_ch;
+			f32* out = dst + i * out_ch;
+
+			const f32 left     = in[0];
+			const f32 right    = in[1];
+			const f32 center   = in[2];
+			const f32 low_freq = in[3];
+
+			if (from == AudioChannelCnt::SURROUND_5_1)
+			{
+				const f32 side_left  = in[4];
+				const f32 side_right = in[5];
+
+				const f32 mid = center * s_backend_center_coef;
+				out[0] = left + mid + side_left * s_backend_surround_coef;
+				out[1] = right + mid + side_right * s_backend_surround_coef;
+			}
+			else
+			{
+				const f32 rear_left  = in[4];
+				const f32 rear_right = in[5];
+				const f32 side_left  = in[6];
+				const f32 side_right = in[7];
+
+				if (to == AudioChannelCnt::SURROUND_5_1)
+				{
+					out[0] = left;
+					out[1] = right;
+					out[2] = center;
+					out[3] = low_freq;
+					out[4] = side_left + rear_left;
+					out[5] = side_right + rear_right;
+				}
+				else
+				{
+					const f32 mid = center * s_backend_center_coef;
+					out[0] = left + mid + (side_left + rear_left) * s_backend_surround_coef;
+					out[1] = right + mid + (side_right + rear_right) * s_backend_surround_coef;
+				}
+			}
+		}
+	}
+
+	template <u32 OutCh, AudioChannelCnt Mode>
+	static void mix_port_8(u32 frame_cnt, f32 m, const be_t<f32>* src, f32* dst)
+	{
+#if defined(ARCH_X64)
+		mix_port_8_sse<OutCh, Mode>(frame_cnt, m, src, dst);
+#else
+		for (u32 i = 0; i < frame_cnt; i++)
+		{
+			mix_port_frame_8<OutCh, Mode>(m, src + i * 8, dst + i * OutCh);
+		}
+#endif
+	}
+
+	template <u32 OutCh>
+	static void mix_port_2(u32 frame_cnt, f32 m, const be_t<f32>* src, f32* dst)
+	{
+#if defined(ARCH_X64)
+		if (OutCh == 2 && s_use_avx2)
+		{
+			return mix_port_2_2_avx2(frame_cnt, m, src, dst);
+		}
+
+		mix_port_2_sse<OutCh>(frame_cnt, m, src, dst);
+#else
+		for (u32 i = 0; i < frame_cnt; i++)
+		{
+			dst[i * OutCh + 0] += src[i * 2 + 0] * m;
+			dst[i * OutCh + 1] += src[i * 2 + 1] * m;
+		}
+#endif
+	}
+
+	template <u32 OutCh>
+	static void mix_port_8_any(u32 frame_cnt, AudioChannelCnt mode, f32 m, const be_t<f32>* src, f32* dst)
+	{
+		switch (mode)
+		{
+		case AudioChannelCnt::STEREO: return mix_port_8<OutCh, AudioChannelCnt::STEREO>(frame_cnt, m, src, dst);
+		case AudioChannelCnt::SURROUND_5_1: return mix_port_8<OutCh, AudioChannelCnt::SURROUND_5_1>(frame_cnt, m, src, dst);
+		case AudioChannelCnt::SURROUND_7_1: return mix_port_8<OutCh, AudioChannelCnt::SURROUND_7_1>(frame_cnt, m, src, dst);
+		}
+
+		fmt::throw_exception("Unknown downmix mode (%u)", static_cast<u32>(mode));
+	}
+
+	void mix_port(u32 frame_cnt, u32 in_ch, u32 out_ch, AudioChannelCnt mode, f32 vol, const be_t<f32>* src, f32* dst)
+	{
+		switch (in_ch << 8 | out_ch)
+		{
+		case 0x202: return mix_port_2<2>(frame_cnt, vol, src, dst);
+		case 0x206: return mix_port_2<6>(frame_cnt, vol, src, dst);
+		case 0x208: return mix_port_2<8>(frame_cnt, vol, src, dst);
+		case 0x802: return mix_port_8_any<2>(frame_cnt, mode, vol, src, dst);
+		case 0x806: return mix_port_8_any<6>(frame_cnt, mode, vol, src, dst);
+		case 0x808: return mix_port_8_any<8>(frame_cnt, mode, vol, src, dst);
+		default: break;
+		}
+
+		fmt::throw_exception("Unsupported port mix (in_ch=%u, out_ch=%u)", in_ch, out_ch);
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "util/endian.hpp"
+
+enum class AudioChannelCnt : u32;
+
+// Sample processing kernels, vectorized on x86 with runtime selection of the AVX2 paths
+// Buffers hold interleaved f32 samples, counts are in samples (not frames) unless stated otherwise
+namespace audio
+{
+	// dst[i] = src[i] * vol, src and dst could be the same
+	void scale(u32 sample_cnt, f32 vol, const f32* src, f32* dst);
+
+	// dst[i] = clamp(src[i], -1.0, 1.0), src and dst could be the same
+	void clamp(u32 sample_cnt, const f32* src, f32* dst);
+
+	// Saturating float to s16 conversion, src and dst could be the same
+	void convert_to_s16(u32 sample_cnt, const f32* src, s16* dst);
+
+	// Downmix from 7.1 or 5.1 to 5.1 or stereo, src and dst could be the same
+	void downmix(u32 sample_cnt, AudioChannelCnt from, AudioChannelCnt to, const f32* src, f32* dst);
+
+	// Scale big-endian frames of a cellAudio port by vol and add them to the mix buffer
+	// in_ch is the port channel count (2 or 8), out_ch the mix buffer channel count (2, 6 or 8)
+	// mode is the backend downmix mode, which selects how 7.1 ports are mapped
+	void mix_port(u32 frame_cnt, u32 in_ch, u32 out_ch, AudioChannelCnt mode, f32 vol, const be_t<f32>* src, f32* dst);
+}
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "Emu/System.h"
+#include "Emu/perf_meter.hpp"
 #include "Emu/Cell/PPUModule.h"
 
 #include "Emu/Cell/lv2/sys_process.h"
@@ -1048,6 +1049,8 @@ void cell_audio_thread::mix(float* out_buffer, s32 offset)
 {
 	AUDIT(out_buffer != nullptr);
 
+	perf_meter<"AUDIOMIX"_u64> perf0;
+
 	constexpr u32 out_channels = static_cast<u32>(channels);
 	constexpr u32 out_buffer_sz = out_channels * AUDIO_BUFFER_SAMPLES;
 
@@ -1063,7 +1066,6 @@ void cell_audio_thread::mix(float* out_buffer, s32 offset)
 
 		auto buf = port.get_vm_ptr(offset);
 
-		static constexpr float minus_3db = 0.707f; // value taken from https://www.dolby.com/us/en/technologies/a-guide-to-dolby-metadata.pdf
 		float m = master_volume;
 
 		// part of cellAudioSetPortLevel functionality
@@ -1087,93 +1089,39 @@ void cell_audio_thread::mix(float* out_buffer, s32 offset)
 			m = port.level * master_volume;
 		};
 
-		if (port.num_channels == 2)
+		if (port.num_channels != 2 && port.num_channels != 8)
 		{
-			for (u32 out = 0, in = 0; out < out_buffer_sz; out += out_channels, in += 2)
-			{
-				step_volume(port);
+			fmt::throw_exception("Unknown channel count (port=%u, channel=%d)", port.number, port.num_channels);
+		}
 
-				const float left  = buf[in + 0] * m;
-				const float right = buf[in + 1] * m;
+		// Pending frames at a constant volume, mixed together
+		u32 run = 0;
 
-				out_buffer[out + 0] += left;
-				out_buffer[out + 1] += right;
-			}
-		}
-		else if (port.num_channels == 8)
+		auto mix_run = [&](u32 end)
 		{
-			for (u32 out = 0, in = 0; out < out_buffer_sz; out += out_channels, in += 8)
+			if (run)
 			{
-				step_volume(port);
-
-				const float left       = buf[in + 0] * m;
-				const float right      = buf[in + 1] * m;
-				const float center     = buf[in + 2] * m;
-				const float low_freq   = buf[in + 3] * m;
-				const float side_left  = buf[in + 4] * m;
-				const float side_right = buf[in + 5] * m;
-				const float rear_left  = buf[in + 6] * m;
-				const float rear_right = buf[in + 7] * m;
-
-				if constexpr (downmix == AudioChannelCnt::STEREO)
-				{
-					// Don't mix in the lfe as per dolby specification and based on documentation
-					const float mid = center * 0.5f;
-					out_buffer[out + 0] += left * minus_3db + mid + side_left * 0.5f + rear_left * 0.5f;
-					out_buffer[out + 1] += right * minus_3db + mid + side_right * 0.5f + rear_right * 0.5f;
-				}
-				else if constexpr (downmix == AudioChannelCnt::SURROUND_5_1)
-				{
-					out_buffer[out + 0] += left;
-					out_buffer[out + 1] += right;
-
-					if constexpr (out_channels >= 6) // Only mix the surround channels into the output if surround output is configured
-					{
-						out_buffer[out + 2] += center;
-						out_buffer[out + 3] += low_freq;
-
-						if constexpr (out_channels == 6)
-						{
-							out_buffer[out + 4] += side_left + rear_left;
-							out_buffer[out + 5] += side_right + rear_right;
-						}
-						else // When using 7.1 ouput, out_buffer[out + 4] and out_buffer[out + 5] are the rear channels, so the side channels need to be mixed into [out + 6] and [out + 7]
-						{
-							out_buffer[out + 6] += side_left + rear_left;
-							out_buffer[out + 7] += side_right + rear_right;
-						}
-					}
-				}
-				else
-				{
-					out_buffer[out + 0] += left;
-					out_buffer[out + 1] += right;
-
-					if constexpr (out_channels >= 6) // Only mix the surround channels into the output if surround output is configured
-					{
-						out_buffer[out + 2] += center;
-						out_buffer[out + 3] += low_freq;
-
-						if constexpr (out_channels == 6)
-						{
-							out_buffer[out + 4] += side_left;
-							out_buffer[out + 5] += side_right;
-						}
-						else
-						{
-							out_buffer[out + 4] += rear_left;
-							out_buffer[out + 5] += rear_right;
-							out_buffer[out + 6] += side_left;
-							out_buffer[out + 7] += side_right;
-						}
-					}
-				}
+				m = port.level * master_volume;
+				audio::mix_port(run, port.num_channels, out_channels, downmix, m, buf + (end - run) * port.num_channels, out_buffer + (end - run) * out_channels);
+				run = 0;
 			}
-		}
-		else
+		};
+
+		// The level is checked for every frame as before, but only the frames of a level change are mixed one by one
+		for (u32 frame = 0; frame < AUDIO_BUFFER_SAMPLES; frame++)
 		{
-			fmt::throw_exception("Unknown channel count (port=%u, channel=%d)", port.number, port.num_channels);
+			if (port.level_set.load().inc == 0.0f)
+			{
+				run++;
+				continue;
+			}
+
+			mix_run(frame);
+			step_volume(port);
+			audio::mix_port(1, port.num_channels, out_channels, downmix, m, buf + frame * port.num_channels, out_buffer + frame * out_channels);
 		}
+
+		mix_run(AUDIO_BUFFER_SAMPLES);
 	}
 }
 
@@ -8,6 +8,9 @@
 #include "cellDmux.h"
 
 #include "util/asm.hpp"
+#include "Utilities/lockless.h"
+
+#include <deque>
 
 LOG_CHANNEL(cellDmux);
 
@@ -152,7 +155,9 @@ class ElementaryStream
 {
 	std::mutex m_mutex;
 
-	squeue_t<u32> entries; // AU starting addresses
+	static constexpr u32 max_au_count = 256;
+
+	std::deque<u32> entries; // AU starting addresses
 	u32 put_count = 0; // number of AU written
 	u32 got_count = 0; // number of AU obtained by GetAu(Ex)
 	u32 released = 0; // number of AU released
@@ -181,12 +186,13 @@ public:
 	const u32 cbArg;
 	const u32 spec; //addr
 
-	std::vector<u8> raw_data; // demultiplexed data stream (managed by demuxer thread)
-	usz raw_pos = 0; // should be <= raw_data.size()
+	std::vector<u8> raw_data; // partial ATRAC3+ frames (managed by demuxer thread)
+	u32 pending = 0; // size of the AU being assembled in place at put + 128 (managed by demuxer thread)
 	u64 last_dts = CODEC_TS_INVALID;
 	u64 last_pts = CODEC_TS_INVALID;
 
-	void push(DemuxerStream& stream, u32 size); // called by demuxer thread (not multithread-safe)
+	void push(DemuxerStream& stream, u32 size); // append to the pending AU directly in the AU buffer, called by demuxer thread
+	void push_raw(DemuxerStream& stream, u32 size); // append to raw_data, called by demuxer thread
 
 	bool isfull(u32 space);
 
@@ -202,16 +208,19 @@ public:
 class Demuxer : public ppu_thread
 {
 public:
-	squeue_t<DemuxerTask, 32> job;
+	lf_queue<DemuxerTask> job;
 	const u32 memAddr;
 	const u32 memSize;
 	const vm::ptr<CellDmuxCbMsg> cbFunc;
 	const u32 cbArg;
-	volatile bool is_finished = false;
-	volatile bool is_closed = false;
+	atomic_t<bool> is_finished = false;
+	atomic_t<bool> is_closed = false;
 	atomic_t<bool> is_running = false;
 	atomic_t<bool> is_working = false;
 
+	// Incremented when a job is queued or an AU is released
+	atomic_t<u32> wakeup = 0;
+
 	Demuxer(u32 addr, u32 size, vm::ptr<CellDmuxCbMsg> func, u32 arg)
 		: ppu_thread({}, "", 0)
 		, memAddr(addr)
@@ -221,10 +230,23 @@ public:
 	{
 	}
 
+	void push_job(const DemuxerTask& task)
+	{
+		job.push(task);
+		notify();
+	}
+
+	void notify()
+	{
+		wakeup++;
+		wakeup.notify_one();
+	}
+
 	void non_task()
 	{
 		DemuxerTask task;
 		DemuxerStream stream = {};
+		lf_queue_slice<DemuxerTask> tasks;
 		ElementaryStream* esALL[96]{};
 		ElementaryStream** esAVC = &esALL[0]; // AVC (max 16 minus M2V count)
 		//ElementaryStream** esM2V = &esALL[16]; // M2V (max 16 minus AVC count)
@@ -237,12 +259,20 @@ public:
 
 		while (true)
 		{
-			if (Emu.IsStopped() || is_closed)
+			if (Emu.IsStopped() || is_closed || thread_ctrl::state() == thread_state::aborting)
 			{
 				break;
 			}
 
-			if (!job.try_peek(task) && is_running && stream.addr)
+			// Read before testing for work, so that no event can be missed
+			const u32 signal = wakeup;
+
+			if (!tasks)
+			{
+				tasks = job.pop_all();
+			}
+
+			if (!tasks && is_running && stream.addr)
 			{
 				// default task (demuxing) (if there is no other work)
 				be_t<u32> code;
@@ -261,6 +291,7 @@ public:
 					lv2_obj::sleep(*this);
 
 					is_working = false;
+					is_working.notify_all();
 
 					stream = {};
 
@@ -366,8 +397,9 @@ public:
 						ElementaryStream& es = *esATX[ch];
 						if (es.raw_data.size() > 1024 * 1024)
 						{
+							// Wait for cellDmuxReleaseAu
 							stream = backup;
-							std::this_thread::sleep_for(1ms); // hack
+							thread_ctrl::wait_on(wakeup, signal);
 							continue;
 						}
 
@@ -384,12 +416,12 @@ public:
 							es.last_pts = pes.pts;
 						}
 
-						es.push(stream, len);
+						es.push_raw(stream, len);
 
 						while (true)
 						{
-							auto const size = es.raw_data.size() - es.raw_pos; // size of available new data
-							auto const data = es.raw_data.data() + es.raw_pos; // pointer to available data
+							auto const size = es.raw_data.size(); // size of available new data
+							auto const data = es.raw_data.data(); // pointer to available data
 
 							if (size < 8) break; // skip if cannot read ATS header
 
@@ -460,11 +492,15 @@ public:
 					{
 						ElementaryStream& es = *esAVC[ch];
 
-						const u32 old_size = ::size32(es.raw_data);
-						if (es.isfull(old_size))
+						// reconstruction of MPEG2-PS stream for vdec module
+						const u32 size = len + pes.size + 9;
+
+						const u32 old_size = es.pending;
+						if (es.isfull(old_size + size))
 						{
+							// Wait for cellDmuxReleaseAu
 							stream = backup;
-							std::this_thread::sleep_for(1ms); // hack
+							thread_ctrl::wait_on(wakeup, signal);
 							continue;
 						}
 
@@ -488,8 +524,6 @@ public:
 							es.last_pts = pes.pts;
 						}
 
-						// reconstruction of MPEG2-PS stream for vdec module
-						const u32 size = len + pes.size + 9;
 						stream = backup;
 						es.push(stream, size);
 					}
@@ -516,12 +550,16 @@ public:
 				continue;
 			}
 
-			// wait for task if no work
-			if (!job.pop(task, &is_closed))
+			if (!tasks)
 			{
-				break; // Emu is stopped
+				// wait for task if no work
+				thread_ctrl::wait_on(wakeup, signal);
+				continue;
 			}
 
+			task = *tasks;
+			tasks.pop_front();
+
 			switch (task.type)
 			{
 			case dmuxSetStream:
@@ -560,6 +598,7 @@ public:
 					stream = {};
 
 					is_working = false;
+					is_working.notify_all();
 				}
 
 				break;
@@ -626,15 +665,15 @@ public:
 			{
 				ElementaryStream& es = *task.es.es_ptr;
 
-				const u32 old_size = ::size32(es.raw_data);
+				const u32 old_size = es.pending;
 				if (old_size && (es.fidMajor & -0x10) == 0xe0)
 				{
 					// TODO (it's only for AVC, some ATX data may be lost)
-					while (es.isfull(old_size))
+					for (u32 signal = wakeup; es.isfull(old_size); signal = wakeup)
 					{
-						if (Emu.IsStopped() || is_closed) break;
+						if (Emu.IsStopped() || is_closed || thread_ctrl::state() == thread_state::aborting) break;
 
-						std::this_thread::sleep_for(1ms); // hack
+						thread_ctrl::wait_on(wakeup, signal);
 					}
 
 					es.push_au(old_size, es.last_dts, es.last_pts, stream.userdata, false, 0);
@@ -680,6 +719,7 @@ public:
 		}
 
 		is_finished = true;
+		is_finished.notify_all();
 	}
 };
 
@@ -772,17 +812,14 @@ bool ElementaryStream::is_full(u32 space)
 {
 	if (released < put_count)
 	{
-		if (entries.is_full())
+		if (entries.size() >= max_au_count)
 		{
 			return true;
 		}
 
-		u32 first = 0;
-		if (!entries.peek(first, 0, &dmux->is_closed) || !first)
-		{
-			fmt::throw_exception("entries.peek() failed");
-		}
-		else if (first >= put)
+		const u32 first = entries.front();
+
+		if (first >= put)
 		{
 			return first - put < space + 128;
 		}
@@ -809,9 +846,16 @@ bool ElementaryStream::isfull(u32 space)
 
 void ElementaryStream::push_au(u32 size, u64 dts, u64 pts, u64 userdata, bool rap, u32 specific)
 {
-	u32 addr;
+	std::lock_guard lock(m_mutex);
+
+	if (pending)
+	{
+		// Assembled in place by push()
+		ensure(size == pending);
+		pending = 0;
+	}
+	else
 	{
-		std::lock_guard lock(m_mutex);
 		ensure(!is_full(size));
 
 		if (put + size + 128 > memAddr + memSize)
@@ -821,42 +865,61 @@ void ElementaryStream::push_au(u32 size, u64 dts, u64 pts, u64 userdata, bool ra
 
 		std::memcpy(vm::base(put + 128), raw_data.data(), size);
 		raw_data.erase(raw_data.begin(), raw_data.begin() + size);
-
-		auto info = vm::ptr<CellDmuxAuInfoEx>::make(put);
-		info->auAddr = put + 128;
-		info->auSize = size;
-		info->dts.lower = static_cast<u32>(dts);
-		info->dts.upper = static_cast<u32>(dts >> 32);
-		info->pts.lower = static_cast<u32>(pts);
-		info->pts.upper = static_cast<u32>(pts >> 32);
-		info->isRap = rap;
-		info->reserved = 0;
-		info->userData = userdata;
-
-		auto spec = vm::ptr<u32>::make(put + u32{sizeof(CellDmuxAuInfoEx)});
-		*spec = specific;
-
-		auto inf = vm::ptr<CellDmuxAuInfo>::make(put + 64);
-		inf->auAddr = put + 128;
-		inf->auSize = size;
-		inf->dtsLower = static_cast<u32>(dts);
-		inf->dtsUpper = static_cast<u32>(dts >> 32);
-		inf->ptsLower = static_cast<u32>(pts);
-		inf->ptsUpper = static_cast<u32>(pts >> 32);
-		inf->auMaxSize = 0; // ?????
-		inf->userData = userdata;
-
-		addr = put;
-
-		put = utils::align(put + 128 + size, 128);
-
-		put_count++;
 	}
 
-	ensure(entries.push(addr, &dmux->is_closed));
+	auto info = vm::ptr<CellDmuxAuInfoEx>::make(put);
+	info->auAddr = put + 128;
+	info->auSize = size;
+	info->dts.lower = static_cast<u32>(dts);
+	info->dts.upper = static_cast<u32>(dts >> 32);
+	info->pts.lower = static_cast<u32>(pts);
+	info->pts.upper = static_cast<u32>(pts >> 32);
+	info->isRap = rap;
+	info->reserved = 0;
+	info->userData = userdata;
+
+	auto spec = vm::ptr<u32>::make(put + u32{sizeof(CellDmuxAuInfoEx)});
+	*spec = specific;
+
+	auto inf = vm::ptr<CellDmuxAuInfo>::make(put + 64);
+	inf->auAddr = put + 128;
+	inf->auSize = size;
+	inf->dtsLower = static_cast<u32>(dts);
+	inf->dtsUpper = static_cast<u32>(dts >> 32);
+	inf->ptsLower = static_cast<u32>(pts);
+	inf->ptsUpper = static_cast<u32>(pts >> 32);
+	inf->auMaxSize = 0; // ?????
+	inf->userData = userdata;
+
+	entries.push_back(put);
+
+	put = utils::align(put + 128 + size, 128);
+
+	put_count++;
 }
 
 void ElementaryStream::push(DemuxerStream& stream, u32 size)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		ensure(!is_full(pending + size));
+
+		if (put + 128 + pending + size > memAddr + memSize)
+		{
+			// Move the incomplete AU to the beginning of the buffer
+			std::memmove(vm::base(memAddr + 128), vm::base(put + 128), pending);
+			put = memAddr;
+		}
+
+		// Append bytes directly to the AU, is_full() guarantees that the area isn't used by unreleased AUs
+		std::memcpy(vm::base(put + 128 + pending), vm::base(stream.addr), size);
+		pending += size;
+	}
+
+	stream.skip(size);
+}
+
+void ElementaryStream::push_raw(DemuxerStream& stream, u32 size)
 {
 	auto const old_size = raw_data.size();
 
@@ -881,13 +944,7 @@ bool ElementaryStream::release()
 		return false;
 	}
 
-	u32 addr = 0;
-	if (!entries.pop(addr, &dmux->is_closed) || !addr)
-	{
-		cellDmux.fatal("es::release() error: entries.Pop() failed");
-		return false;
-	}
-
+	entries.pop_front();
 	released++;
 	return true;
 }
@@ -905,12 +962,7 @@ bool ElementaryStream::peek(u32& out_data, bool no_ex, u32& out_spec, bool updat
 		return false;
 	}
 
-	u32 addr = 0;
-	if (!entries.peek(addr, got_count - released, &dmux->is_closed) || !addr)
-	{
-		cellDmux.fatal("es::peek() error: entries.Peek() failed");
-		return false;
-	}
+	const u32 addr = ::at32(entries, got_count - released);
 
 	out_data = no_ex ? addr + 64 : addr;
 	out_spec = addr + sizeof(CellDmuxAuInfoEx);
@@ -931,7 +983,7 @@ void ElementaryStream::reset()
 	got_count = 0;
 	released = 0;
 	raw_data.clear();
-	raw_pos = 0;
+	pending = 0;
 }
 
 void dmuxQueryAttr(u32 /* info_addr, may be 0 */, vm::ptr<CellDmuxAttr> attr)
@@ -1039,17 +1091,18 @@ error_code cellDmuxClose(u32 handle)
 	}
 
 	dmux->is_closed = true;
-	dmux->job.try_push(DemuxerTask(dmuxClose));
+	dmux->is_working.notify_all();
+	dmux->push_job(DemuxerTask(dmuxClose));
 
 	while (!dmux->is_finished)
 	{
-		if (Emu.IsStopped())
+		if (Emu.IsStopped() || thread_ctrl::state() == thread_state::aborting)
 		{
 			cellDmux.warning("cellDmuxClose(%d) aborted", handle);
 			return CELL_OK;
 		}
 
-		std::this_thread::sleep_for(1ms); // hack
+		thread_ctrl::wait_on(dmux->is_finished, false);
 	}
 
 	idm::remove<ppu_thread>(handle);
@@ -1069,7 +1122,6 @@ error_code cellDmuxSetStream(u32 handle, u32 streamAddress, u32 streamSize, b8 d
 
 	if (dmux->is_running.exchange(true))
 	{
-		//std::this_thread::sleep_for(1ms); // hack
 		return CELL_DMUX_ERROR_BUSY;
 	}
 
@@ -1080,7 +1132,7 @@ error_code cellDmuxSetStream(u32 handle, u32 streamAddress, u32 streamSize, b8 d
 	info.discontinuity = discontinuity;
 	info.userdata = userData;
 
-	dmux->job.push(task, &dmux->is_closed);
+	dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1095,7 +1147,7 @@ error_code cellDmuxResetStream(u32 handle)
 		return CELL_DMUX_ERROR_ARG;
 	}
 
-	dmux->job.push(DemuxerTask(dmuxResetStream), &dmux->is_closed);
+	dmux->push_job(DemuxerTask(dmuxResetStream));
 	return CELL_OK;
 }
 
@@ -1117,16 +1169,17 @@ error_code cellDmuxResetStreamAndWaitDone(u32 handle)
 
 	dmux->is_working = true;
 
-	dmux->job.push(DemuxerTask(dmuxResetStreamAndWaitDone), &dmux->is_closed);
+	dmux->push_job(DemuxerTask(dmuxResetStreamAndWaitDone));
 
 	while (dmux->is_running && dmux->is_working && !dmux->is_closed) // TODO: ensure that it is safe
 	{
-		if (Emu.IsStopped())
+		if (Emu.IsStopped() || thread_ctrl::state() == thread_state::aborting)
 		{
 			cellDmux.warning("cellDmuxResetStreamAndWaitDone(%d) aborted", handle);
 			return CELL_OK;
 		}
-		std::this_thread::sleep_for(1ms); // hack
+
+		thread_ctrl::wait_on(dmux->is_working, true);
 	}
 
 	return CELL_OK;
@@ -1186,7 +1239,7 @@ error_code cellDmuxEnableEs(u32 handle, vm::cptr<CellCodecEsFilterId> esFilterId
 	task.es.es = es->id;
 	task.es.es_ptr = es.get();
 
-	dmux->job.push(task, &dmux->is_closed);
+	dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1205,7 +1258,7 @@ error_code cellDmuxDisableEs(u32 esHandle)
 	task.es.es = esHandle;
 	task.es.es_ptr = es.get();
 
-	es->dmux->job.push(task, &es->dmux->is_closed);
+	es->dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1224,7 +1277,7 @@ error_code cellDmuxResetEs(u32 esHandle)
 	task.es.es = esHandle;
 	task.es.es_ptr = es.get();
 
-	es->dmux->job.push(task, &es->dmux->is_closed);
+	es->dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1335,6 +1388,9 @@ error_code cellDmuxReleaseAu(u32 esHandle)
 	{
 		return CELL_DMUX_ERROR_SEQ;
 	}
+
+	// Resume the demuxer if it was waiting for space
+	es->dmux->notify();
 	return CELL_OK;
 }
 
@@ -1353,7 +1409,7 @@ error_code cellDmuxFlushEs(u32 esHandle)
 	task.es.es = esHandle;
 	task.es.es_ptr = es.get();
 
-	es->dmux->job.push(task, &es->dmux->is_closed);
+	es->dmux->push_job(task);
 	return CELL_OK;
 }
 
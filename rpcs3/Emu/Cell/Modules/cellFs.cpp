@@ -5,6 +5,9 @@
 
 #include "Emu/Cell/lv2/sys_fs.h"
 #include "Emu/Cell/lv2/sys_sync.h"
+#include "Emu/Cell/lv2/sys_ppu_thread.h"
+#include "Utilities/lockless.h"
+#include "sysPrxForUser.h"
 #include "cellFs.h"
 
 #include <mutex>
@@ -890,123 +893,284 @@ s32 cellFsStReadWaitCallback(u32 fd, u64 size, vm::ptr<void(s32 xfd, u64 xsize)>
 
 using fs_aio_cb_t = vm::ptr<void(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)>;
 
-struct fs_aio_thread : ppu_thread
+struct fs_aio_request
 {
-	using ppu_thread::ppu_thread;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+	s32 xid = 0;
+	s32 error = CELL_OK;
+	bool is_write = false;
+	bool sync = false; // No host handle, execute on the AIO thread
 
-	void non_task()
-	{
-		while (cmd64 cmd = cmd_wait())
-		{
-			const u32 type = cmd.arg1<u32>();
-			const s32 xid = cmd.arg2<s32>();
-			const cmd64 cmd2 = cmd_get(1);
-			const auto aio = cmd2.arg1<vm::ptr<CellFsAio>>();
-			const auto func = cmd2.arg2<fs_aio_cb_t>();
-			cmd_pop(1);
+	std::shared_ptr<lv2_file> file;
+	u64 offset = 0;
+	u64 size = 0;
+	u64 transferred = 0;
+	bool ok = true;
 
-			s32 error = CELL_EBADF;
-			u64 result = 0;
+	// Intermediate buffer, empty if the host read directly into guest memory
+	std::vector<u8> buffer;
+};
 
-			const auto file = idm::get<lv2_fs_object, lv2_file>(aio->fd);
+struct fs_aio_manager
+{
+	shared_mutex mutex;
 
-			if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
-			{
-			}
-			else if (std::lock_guard lock(file->mp->mutex); file->file)
-			{
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
+	// cellFsAioInit calls not matched by cellFsAioFinish
+	u32 users = 0;
 
-				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+	// HLE interrupt thread executing the callbacks
+	atomic_t<u32> ppu_tid = 0;
 
-				file->file.seek(old_pos);
-				error = CELL_OK;
-			}
+	// Requests submitted and not yet reported to the game
+	atomic_t<u32> pending = 0;
+	atomic_t<bool> finishing = false;
 
-			func(*this, aio, error, xid, result);
-			lv2_obj::sleep(*this);
-		}
-	}
+	// Shared with the engine callbacks
+	const std::shared_ptr<lf_queue<fs_aio_request>> completed = std::make_shared<lf_queue<fs_aio_request>>();
 };
 
-struct fs_aio_manager
+atomic_t<s32> g_fs_aio_id;
+
+static void fs_aio_finish_request(ppu_thread& ppu, fs_aio_request& req)
 {
-	std::shared_ptr<fs_aio_thread> thread;
+	const auto& aio = req.aio;
+	const auto& file = req.file;
 
-	shared_mutex mutex;
-};
+	if (!req.error && !req.sync)
+	{
+		if (!req.is_write && !req.buffer.empty())
+		{
+			std::memcpy(aio->buf.get_ptr(), req.buffer.data(), req.transferred);
+		}
 
-s32 cellFsAioInit(vm::cptr<char> mount_point)
-{
-	cellFs.warning("cellFsAioInit(mount_point=%s)", mount_point);
+		// The host stopped early: error, or destination locked by the RSX caches in the meantime
+		req.sync = !req.ok || (req.transferred < req.size && (req.is_write || req.offset + req.transferred < file->file.size()));
+	}
 
-	// TODO: create AIO thread (if not exists) for specified mount point
-	cellFs.fatal("cellFsAio disabled, use LLE.");
+	if (!req.error && req.sync)
+	{
+		std::lock_guard lock(file->mp->mutex);
 
-	return CELL_OK;
+		if (file->file)
+		{
+			const auto old_pos = file->file.pos(); file->file.seek(req.offset + req.transferred);
+
+			req.transferred += req.is_write
+				? file->op_write(vm::cast(aio->buf.addr() + req.transferred), req.size - req.transferred)
+				: file->op_read(vm::cast(aio->buf.addr() + req.transferred), req.size - req.transferred);
+
+			file->file.seek(old_pos);
+		}
+		else
+		{
+			req.error = CELL_EBADF;
+		}
+	}
+
+	req.func(ppu, aio, req.error, req.xid, req.error ? 0 : req.transferred);
+	lv2_obj::sleep(ppu);
 }
 
-s32 cellFsAioFinish(vm::cptr<char> mount_point)
+extern void fsAioEntry(ppu_thread& ppu, u32)
 {
-	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
+	auto& m = g_fxo->get<fs_aio_manager>();
 
-	// TODO: delete existing AIO thread for specified mount point
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		for (auto&& req : m.completed->pop_all())
+		{
+			if (!req.aio)
+			{
+				// Wake-up request from cellFsAioFinish
+				continue;
+			}
 
-	return CELL_OK;
-}
+			fs_aio_finish_request(ppu, req);
+			m.pending--;
+		}
 
-atomic_t<s32> g_fs_aio_id;
+		if (m.finishing && !m.pending)
+		{
+			break;
+		}
 
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
-{
-	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+		thread_ctrl::wait_on(*m.completed, nullptr);
+	}
+
+	ppu.state += cpu_flag::exit;
+}
 
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+error_code cellFsAioInit(ppu_thread& ppu, vm::cptr<char> mount_point)
+{
+	cellFs.warning("cellFsAioInit(mount_point=%s)", mount_point);
 
+	// TODO: one AIO thread per mount point, all of them share the host engine anyway
 	auto& m = g_fxo->get<fs_aio_manager>();
 
-	if (!m.thread)
+	std::lock_guard lock(m.mutex);
+
+	if (m.users++)
 	{
-		return CELL_ENXIO;
+		return CELL_OK;
 	}
 
-	const s32 xid = (*id = ++g_fs_aio_id);
+	m.finishing = false;
+
+	vm::var<u64> _tid;
+	vm::var<char[]> _name = vm::make_str("HLE FS AIO");
+	ppu_execute<&sys_ppu_thread_create>(ppu, +_tid, 0x10000, 0, 1001, 0x4000, SYS_PPU_THREAD_CREATE_INTERRUPT, +_name);
+
+	const auto thrd = idm::get<named_thread<ppu_thread>>(static_cast<u32>(*_tid));
 
-	m.thread->cmd_list
+	thrd->cmd_list
 	({
-		{ 1, xid },
-		{ aio, func },
+		{ ppu_cmd::set_args, 1 }, u64{0},
+		{ ppu_cmd::hle_call, FIND_FUNC(fsAioEntry) },
 	});
 
+	m.ppu_tid = thrd->id;
+
+	thrd->state -= cpu_flag::stop;
+	thrd->state.notify_one(cpu_flag::stop);
+
 	return CELL_OK;
 }
 
-s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+error_code cellFsAioFinish(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
-	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
+
+	auto& m = g_fxo->get<fs_aio_manager>();
+
+	std::lock_guard lock(m.mutex);
 
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+	if (!m.users || --m.users)
+	{
+		return CELL_OK;
+	}
 
+	// Let the thread report the remaining requests, then join it
+	m.finishing = true;
+	m.completed->push(fs_aio_request{});
+
+	if (const u32 tid = m.ppu_tid.exchange(0))
+	{
+		lv2_obj::sleep(ppu);
+		ppu_execute<&sys_interrupt_thread_disestablish>(ppu, tid);
+	}
+
+	return CELL_OK;
+}
+
+static error_code fs_aio_submit(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func, bool is_write)
+{
 	auto& m = g_fxo->get<fs_aio_manager>();
 
-	if (!m.thread)
+	reader_lock lock(m.mutex);
+
+	if (!m.ppu_tid)
 	{
 		return CELL_ENXIO;
 	}
 
 	const s32 xid = (*id = ++g_fs_aio_id);
 
-	m.thread->cmd_list
-	({
-		{ 2, xid },
-		{ aio, func },
-	});
+	fs_aio_request req;
+	req.aio = aio;
+	req.func = func;
+	req.xid = xid;
+	req.is_write = is_write;
+	req.offset = aio->offset;
+	req.size = aio->size;
+	req.file = idm::get<lv2_fs_object, lv2_file>(aio->fd);
+
+	m.pending++;
+
+	fs::native_handle handle{};
 
+	if (!req.file || (!is_write && req.file->flags & CELL_FS_O_WRONLY) || (is_write && !(req.file->flags & CELL_FS_O_ACCMODE)))
+	{
+		req.error = CELL_EBADF;
+	}
+	else
+	{
+		// sys_fs_close waits for aio_pending under the same lock before closing the host file
+		// So the handle stays valid (and can't be reused by another file) until the request completes
+		std::lock_guard file_lock(req.file->mp->mutex);
+
+		if (!req.file->file)
+		{
+			req.error = CELL_EBADF;
+		}
+		else if (handle = req.file->file.get_handle(); !fs::is_native_handle(handle) || !req.size)
+		{
+			// Emulated file (e.g. decrypted or MSELF view), no host request possible
+			req.sync = true;
+		}
+		else
+		{
+			req.file->aio_pending++;
+		}
+	}
+
+	if (req.error == CELL_OK && !req.sync)
+	{
+		void* data = aio->buf.get_ptr();
+
+		if (is_write || !lv2_file::can_transfer_direct(aio->buf.addr(), req.size, false))
+		{
+			// Writes are snapshotted at submission, reads are copied on completion
+			req.buffer.resize(req.size);
+			data = req.buffer.data();
+
+			if (is_write)
+			{
+				std::memcpy(data, aio->buf.get_ptr(), req.size);
+			}
+		}
+
+		fs::aio_request host;
+		host.handle = handle;
+		host.offset = req.offset;
+		host.data = data;
+		host.size = req.size;
+		host.is_write = is_write;
+		host.on_complete = [queue = m.completed, req = std::move(req)](u64 transferred, bool ok) mutable
+		{
+			req.transferred = transferred;
+			req.ok = ok;
+
+			if (!--req.file->aio_pending)
+			{
+				req.file->aio_pending.notify_all();
+			}
+
+			queue->push(std::move(req));
+		};
+
+		g_fxo->get<lv2_fs_aio>().get().submit(std::move(host));
+		return CELL_OK;
+	}
+
+	m.completed->push(std::move(req));
 	return CELL_OK;
 }
 
+error_code cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+
+	return fs_aio_submit(aio, id, func, false);
+}
+
+error_code cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+
+	return fs_aio_submit(aio, id, func, true);
+}
+
 s32 cellFsAioCancel(s32 id)
 {
 	cellFs.todo("cellFsAioCancel(id=%d) -> CELL_EINVAL", id);
@@ -1116,4 +1280,6 @@ DECLARE(ppu_module_manager::cellFs)("sys_fs", []()
 	REG_FUNC(sys_fs, cellFsUtime);
 	REG_FUNC(sys_fs, cellFsWrite).flag(MFF_PERFECT);
 	REG_FUNC(sys_fs, cellFsWriteWithOffset);
+
+	REG_HIDDEN_FUNC(fsAioEntry);
 });
@@ -179,7 +179,6 @@ error_code cell_music_decode_read(vm::ptr<void> buf, vm::ptr<u32> startTime, u64
 
 	auto& dec = g_fxo->get<Music_Decode>();
 	std::lock_guard lock(dec.mutex);
-	std::scoped_lock slock(dec.decoder.m_mtx);
 
 	if (dec.decoder.has_error)
 	{
@@ -191,14 +190,16 @@ error_code cell_music_decode_read(vm::ptr<void> buf, vm::ptr<u32> startTime, u64
 		return CELL_MUSIC_DECODE_ERROR_NO_LPCM_DATA;
 	}
 
-	const u64 size_left = dec.decoder.m_size - dec.read_pos;
+	// Check this first, no more data is added once the track is fully decoded
+	const bool track_fully_decoded = dec.decoder.track_fully_decoded;
+	const u64 size_left = dec.decoder.get_available_size();
 
 	if (dec.read_pos == 0)
 	{
 		cellMusicDecode.trace("cell_music_decode_read: position=CELL_MUSIC_DECODE_POSITION_START, read_pos=%d, reqSize=%d, m_size=%d", dec.read_pos, reqSize, dec.decoder.m_size.load());
 		*position = CELL_MUSIC_DECODE_POSITION_START;
 	}
-	else if (!dec.decoder.track_fully_decoded || size_left > reqSize) // track_fully_decoded is not guarded by a mutex, but since it is set to true after the decode, it should be fine.
+	else if (!track_fully_decoded || size_left > reqSize)
 	{
 		cellMusicDecode.trace("cell_music_decode_read: position=CELL_MUSIC_DECODE_POSITION_MID, read_pos=%d, reqSize=%d, m_size=%d", dec.read_pos, reqSize, dec.decoder.m_size.load());
 		*position = CELL_MUSIC_DECODE_POSITION_MID;
@@ -217,7 +218,8 @@ error_code cell_music_decode_read(vm::ptr<void> buf, vm::ptr<u32> startTime, u64
 		}
 	}
 
-	const u64 size_to_read = std::min(reqSize, size_left);
+	u32 start_time_ms = 0;
+	const u64 size_to_read = dec.decoder.read(buf.get_ptr(), std::min(reqSize, size_left), start_time_ms);
 	*readSize = size_to_read;
 
 	if (size_to_read == 0)
@@ -225,23 +227,9 @@ error_code cell_music_decode_read(vm::ptr<void> buf, vm::ptr<u32> startTime, u64
 		return CELL_MUSIC_DECODE_ERROR_NO_LPCM_DATA; // TODO: speculative
 	}
 
-	std::memcpy(buf.get_ptr(), &dec.decoder.data[dec.read_pos], size_to_read);
-
 	dec.read_pos += size_to_read;
 
-	s64 start_time_ms = 0;
-
-	if (!dec.decoder.timestamps_ms.empty())
-	{
-		start_time_ms = dec.decoder.timestamps_ms.front().second;
-
-		while (dec.decoder.timestamps_ms.size() > 1 && dec.read_pos >= ::at32(dec.decoder.timestamps_ms, 1).first)
-		{
-			dec.decoder.timestamps_ms.pop_front();
-		}
-	}
-
-	*startTime = static_cast<u32>(start_time_ms); // startTime is milliseconds
+	*startTime = start_time_ms; // startTime is milliseconds
 
 	switch (*position)
 	{
@@ -255,9 +243,7 @@ error_code cell_music_decode_read(vm::ptr<void> buf, vm::ptr<u32> startTime, u64
 	case CELL_MUSIC_DECODE_POSITION_END:
 	{
 		dec.read_pos = 0;
-		dec.decoder.clear();
-		dec.decoder.track_fully_consumed = true;
-		dec.decoder.track_fully_consumed.notify_one();
+		dec.decoder.finish_track();
 		break;
 	}
 	default:
@@ -359,11 +345,7 @@ error_code cellMusicDecodeSetDecodeCommand(s32 command)
 	if (!dec.func)
 		return CELL_MUSIC_DECODE_ERROR_GENERIC;
 
-	error_code result = CELL_OK;
-	{
-		std::scoped_lock slock(dec.decoder.m_mtx);
-		result = dec.set_decode_command(command);
-	}
+	const error_code result = dec.set_decode_command(command);
 
 	sysutil_register_cb([&dec, result](ppu_thread& ppu) -> s32
 	{
@@ -544,11 +526,7 @@ error_code cellMusicDecodeSetDecodeCommand2(s32 command)
 	if (!dec.func)
 		return CELL_MUSIC_DECODE_ERROR_GENERIC;
 
-	error_code result = CELL_OK;
-	{
-		std::scoped_lock slock(dec.decoder.m_mtx);
-		result = dec.set_decode_command(command);
-	}
+	const error_code result = dec.set_decode_command(command);
 
 	sysutil_register_cb([&dec, result](ppu_thread& ppu) -> s32
 	{
@@ -2,6 +2,7 @@
 #include "Emu/IdManager.h"
 #include "Emu/system_config.h"
 #include "Emu/Cell/PPUModule.h"
+#include "Emu/Cell/timers.hpp"
 #include "Emu/Cell/lv2/sys_process.h"
 #include "Emu/Io/pad_types.h"
 #include "Input/pad_thread.h"
@@ -63,6 +64,14 @@ void pad_info::save(utils::serial& ar)
 	ar(max_connect, port_setting);
 }
 
+pad_info::~pad_info()
+{
+	if (latency_count)
+	{
+		sys_io.notice("Pad input latency: %u events, average %u us, max %u us", latency_count, latency_total / latency_count, latency_max);
+	}
+}
+
 
 error_code cellPadInit(u32 max_connect)
 {
@@ -390,6 +399,16 @@ void pad_get_data(u32 port_no, CellPadData* data)
 
 	pad->m_buffer_cleared = false;
 
+	// Input that didn't change the returned state is not counted later either
+	if (const u64 input_time = pad->m_input_timestamp.exchange(0); input_time && data->len > CELL_PAD_LEN_NO_CHANGE)
+	{
+		const u64 now = get_system_time();
+		const u64 latency = now - std::min(input_time, now);
+		config.latency_count++;
+		config.latency_total += latency;
+		config.latency_max = std::max(config.latency_max, latency);
+	}
+
 	// only update parts of the output struct depending on the controller setting
 	if (data->len > CELL_PAD_LEN_NO_CHANGE)
 	{
@@ -199,10 +199,16 @@ struct pad_info
 	atomic_t<u32> max_connect = 0;
 	std::array<u32, CELL_PAD_MAX_PORT_NUM> port_setting{ 0 };
 
+	// Time from a host input event to the cellPadGetData call returning it, in microseconds (not saved)
+	u64 latency_count = 0;
+	u64 latency_total = 0;
+	u64 latency_max = 0;
+
 	SAVESTATE_INIT_POS(11);
 
 	pad_info() = default;
 	pad_info(utils::serial& ar);
+	~pad_info();
 	void save(utils::serial& ar);
 };
 
@@ -5,6 +5,7 @@
 #include "Emu/IdManager.h"
 #include "Emu/system_config.h"
 #include "Emu/VFS.h"
+#include "Emu/Io/recording_config.h"
 #include "cellRec.h"
 #include "cellSysutil.h"
 #include "util/media_utils.h"
@@ -152,6 +153,11 @@ public:
 	{
 		cellRec.notice("Stopping image sink. flush=%d", flush);
 
+		if (const u64 dropped = m_dropped_frames.exchange(0))
+		{
+			cellRec.warning("Image sink dropped %d frames", dropped);
+		}
+
 		std::lock_guard lock(m_mtx);
 		m_flush = flush;
 		m_frames_to_encode.clear();
@@ -165,7 +171,7 @@ public:
 		if (m_flush)
 			return;
 
-		m_frames_to_encode.emplace_back(timestamp_ms, width, height, pixel_format, std::move(frame));
+		queue_frame(frame, width, height, pixel_format, timestamp_ms);
 	}
 
 	encoder_frame get_frame()
@@ -536,6 +542,9 @@ void rec_info::start_image_provider()
 		const bool use_ring_buffer = param.ring_sec > 0;
 		const usz frame_size = input_format.pitch * input_format.height;
 
+		// Reused for external frames, the encoder hands back recycled buffers
+		std::vector<u8> external_frame;
+
 		cellRec.notice("image_provider_thread: use_ring_buffer=%d, video_ringbuffer_size=%d, audio_ringbuffer_size=%d, ring_sec=%d, frame_size=%d, use_external_video=%d, use_external_audio=%d, use_internal_audio=%d", use_ring_buffer, video_ringbuffer.size(), audio_ringbuffer.size(), param.ring_sec, frame_size, use_external_video, use_external_audio, use_internal_audio);
 
 		while (thread_ctrl::state() != thread_state::aborting && encoder)
@@ -585,9 +594,9 @@ void rec_info::start_image_provider()
 						}
 						else
 						{
-							std::vector<u8> frame(frame_size);
-							std::memcpy(frame.data(), video_input_buffer.get_ptr(), frame.size());
-							encoder->add_frame(frame, input_format.pitch, input_format.height, input_format.av_pixel_format, timestamp_ms);
+							external_frame.resize(frame_size);
+							std::memcpy(external_frame.data(), video_input_buffer.get_ptr(), external_frame.size());
+							encoder->add_frame(external_frame, input_format.pitch, input_format.height, input_format.av_pixel_format, timestamp_ms);
 						}
 					}
 
@@ -602,11 +611,14 @@ void rec_info::start_image_provider()
 				{
 					ensure(frame.data.size() == frame_size);
 					utils::image_sink::encoder_frame& frame_data = video_ringbuffer[next_video_ring_pos()];
-					frame_data = std::move(frame);
+					std::swap(frame_data, frame);
 					frame_data.pts = pts;
 					last_pts = pts;
 					video_ring_frame_count++;
 				}
+
+				// Give the previous buffer of the ring slot (or the skipped frame) back to the sink
+				image_sink->recycle_frame(std::move(frame));
 			}
 
 			if (use_internal_audio)
@@ -680,6 +692,13 @@ void rec_info::stop_image_provider(bool flush)
 		{
 			const usz pos = (start_offset + i) % video_ringbuffer.size();
 			utils::image_sink::encoder_frame& frame_data = video_ringbuffer[pos];
+
+			// Don't let the frame queue of the encoder overflow (give up after a second, the frame is dropped then)
+			for (u32 wait = 0; wait < 1000 && !encoder->can_add_frame() && !encoder->has_error; wait++)
+			{
+				thread_ctrl::wait_for(1000);
+			}
+
 			encoder->add_frame(frame_data.data, frame_data.width, frame_data.height, frame_data.av_pixel_format, encoder->get_timestamp_ms(frame_data.pts - start_pts));
 
 			// TODO: add audio data to encoder
@@ -1084,6 +1103,7 @@ error_code cellRecOpen(vm::cptr<char> pDirName, vm::cptr<char> pFileName, vm::cp
 	rec.encoder->set_audio_bitrate(rec.audio_bps);
 	rec.encoder->set_audio_codec(rec.audio_codec_id);
 	rec.encoder->set_output_format(rec.output_format);
+	rec.encoder->set_thread_count(g_cfg_recording.encoder_threads);
 
 	sysutil_register_cb([&rec](ppu_thread& ppu) -> s32
 	{
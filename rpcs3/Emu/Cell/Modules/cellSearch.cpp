@@ -111,6 +111,46 @@ struct search_object_t
 	std::vector<content_id_type> content_ids;
 };
 
+// Check if the extension of a file belongs to a container of the audio or video codecs in CellSearchCodec
+bool is_media_file(std::string_view name, s32 av_media_type)
+{
+	static constexpr std::string_view audio_extensions[] = { "mp3", "aac", "m4a", "mp4", "3gp", "wav", "wma", "oma", "aa3", "at3", "ac3" };
+	static constexpr std::string_view video_extensions[] = { "mp4", "m4v", "3gp", "mpg", "mpeg", "m2p", "m2ts", "mts", "ts", "avi", "divx", "wmv" };
+
+	const usz ext_offset = name.find_last_of('.');
+
+	if (ext_offset == umax)
+	{
+		return false;
+	}
+
+	const std::string ext = fmt::to_lower(std::string(name.substr(ext_offset + 1)));
+
+	if (av_media_type == 1) // AVMEDIA_TYPE_AUDIO
+	{
+		return std::find(std::begin(audio_extensions), std::end(audio_extensions), ext) != std::end(audio_extensions);
+	}
+
+	return std::find(std::begin(video_extensions), std::end(video_extensions), ext) != std::end(video_extensions);
+}
+
+// Probe the media files of a folder in parallel ahead of the search, the results are kept in the media index
+// Files with other extensions are still probed one by one if the search asks for them
+void prefetch_media_info(const std::string& host_dir, const std::vector<fs::dir_entry>& items, s32 av_media_type)
+{
+	std::vector<std::pair<std::string, fs::stat_t>> files;
+
+	for (const auto& item : items)
+	{
+		if (!item.is_directory && is_media_file(item.name, av_media_type))
+		{
+			files.emplace_back(host_dir + "/" + item.name, item);
+		}
+	}
+
+	g_fxo->get<utils::media_index>().prefetch(files, av_media_type);
+}
+
 error_code check_search_state(search_state state, search_state action)
 {
 	switch (action)
@@ -835,6 +875,11 @@ error_code cellSearchStartContentSearchInList(vm::cptr<CellSearchContentId> list
 
 			// TODO: Use sortKey (CellSearchSortKey) to allow for sorting by category
 
+			if (type == CELL_SEARCH_CONTENTSEARCHTYPE_MUSIC_ALL || type == CELL_SEARCH_CONTENTSEARCHTYPE_VIDEO_ALL)
+			{
+				prefetch_media_info(vfs::get(vpath), files_sorted, type == CELL_SEARCH_CONTENTSEARCHTYPE_MUSIC_ALL ? 1 : 0); // AVMEDIA_TYPE_AUDIO : AVMEDIA_TYPE_VIDEO
+			}
+
 			for (auto&& item : files_sorted)
 			{
 				// TODO
@@ -873,7 +918,7 @@ error_code cellSearchStartContentSearchInList(vm::cptr<CellSearchContentId> list
 						curr_find->type = CELL_SEARCH_CONTENTTYPE_MUSIC;
 
 						const std::string path = vfs::get(vpath) + "/" + item.name;
-						const auto [success, mi] = utils::get_media_info(path, 1); // AVMEDIA_TYPE_AUDIO
+						const auto [success, mi] = g_fxo->get<utils::media_index>().get_media_info(path, item, 1); // AVMEDIA_TYPE_AUDIO
 						if (!success)
 						{
 							continue;
@@ -894,7 +939,7 @@ error_code cellSearchStartContentSearchInList(vm::cptr<CellSearchContentId> list
 						curr_find->type = CELL_SEARCH_CONTENTTYPE_VIDEO;
 
 						const std::string path = vfs::get(vpath) + "/" + item.name;
-						const auto [success, mi] = utils::get_media_info(path, 0); // AVMEDIA_TYPE_VIDEO
+						const auto [success, mi] = g_fxo->get<utils::media_index>().get_media_info(path, item, 0); // AVMEDIA_TYPE_VIDEO
 						if (!success)
 						{
 							continue;
@@ -930,6 +975,7 @@ error_code cellSearchStartContentSearchInList(vm::cptr<CellSearchContentId> list
 		};
 
 		searchInFolder(list_path);
+		g_fxo->get<utils::media_index>().flush();
 		resultParam->resultNum = ::narrow<s32>(curr_search->content_ids.size());
 
 		search.state.store(search_state::idle);
@@ -1062,6 +1108,8 @@ error_code cellSearchStartContentSearch(CellSearchContentSearchType type, CellSe
 		{
 			const std::string relative_vpath = (!prev.empty() ? prev + "/" : "") + vpath;
 
+			std::vector<fs::dir_entry> items;
+
 			for (auto&& item : fs::dir(vfs::get(relative_vpath)))
 			{
 				item.name = vfs::unescape(item.name);
@@ -1071,6 +1119,16 @@ error_code cellSearchStartContentSearch(CellSearchContentSearchType type, CellSe
 					continue;
 				}
 
+				items.push_back(std::move(item));
+			}
+
+			if (type == CELL_SEARCH_CONTENTSEARCHTYPE_MUSIC_ALL || type == CELL_SEARCH_CONTENTSEARCHTYPE_VIDEO_ALL)
+			{
+				prefetch_media_info(vfs::get(relative_vpath), items, type == CELL_SEARCH_CONTENTSEARCHTYPE_MUSIC_ALL ? 1 : 0); // AVMEDIA_TYPE_AUDIO : AVMEDIA_TYPE_VIDEO
+			}
+
+			for (auto&& item : items)
+			{
 				if (item.is_directory)
 				{
 					searchInFolder(item.name, relative_vpath);
@@ -1113,8 +1171,8 @@ error_code cellSearchStartContentSearch(CellSearchContentSearchType type, CellSe
 					{
 						curr_find->type = CELL_SEARCH_CONTENTTYPE_MUSIC;
 
-						const std::string path = vfs::get(vpath) + "/" + item.name;
-						const auto [success, mi] = utils::get_media_info(path, 1); // AVMEDIA_TYPE_AUDIO
+						const std::string path = vfs::get(relative_vpath) + "/" + item.name;
+						const auto [success, mi] = g_fxo->get<utils::media_index>().get_media_info(path, item, 1); // AVMEDIA_TYPE_AUDIO
 						if (!success)
 						{
 							continue;
@@ -1134,8 +1192,8 @@ error_code cellSearchStartContentSearch(CellSearchContentSearchType type, CellSe
 					{
 						curr_find->type = CELL_SEARCH_CONTENTTYPE_VIDEO;
 
-						const std::string path = vfs::get(vpath) + "/" + item.name;
-						const auto [success, mi] = utils::get_media_info(path, 0); // AVMEDIA_TYPE_VIDEO
+						const std::string path = vfs::get(relative_vpath) + "/" + item.name;
+						const auto [success, mi] = g_fxo->get<utils::media_index>().get_media_info(path, item, 0); // AVMEDIA_TYPE_VIDEO
 						if (!success)
 						{
 							continue;
@@ -1171,6 +1229,7 @@ error_code cellSearchStartContentSearch(CellSearchContentSearchType type, CellSe
 		};
 
 		searchInFolder(fmt::format("/dev_hdd0/%s", media_dir), "");
+		g_fxo->get<utils::media_index>().flush();
 		resultParam->resultNum = ::narrow<s32>(curr_search->content_ids.size());
 
 		search.state.store(search_state::idle);
@@ -2230,7 +2289,10 @@ error_code music_selection_context::find_content_id(vm::ptr<CellSearchContentId>
 
 			if (hash == file_hash)
 			{
-				const auto [success, mi] = utils::get_media_info(vfs_dir_path + "/" + item.name, 1); // AVMEDIA_TYPE_AUDIO
+				auto& index = g_fxo->get<utils::media_index>();
+				const auto [success, mi] = index.get_media_info(vfs_dir_path + "/" + item.name, item, 1); // AVMEDIA_TYPE_AUDIO
+				index.flush();
+
 				if (!success)
 				{
 					continue;
@@ -1,7 +1,9 @@
 #include "stdafx.h"
 #include "Loader/ELF.h"
 
+#include "Emu/system_config.h"
 #include "Emu/Memory/vm_reservation.h"
+#include "Emu/Cell/timers.hpp"
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/SPURecompiler.h"
 #include "Emu/Cell/lv2/sys_lwmutex.h"
@@ -13,6 +15,8 @@
 #include "util/v128.hpp"
 #include "util/simd.hpp"
 
+#include <optional>
+
 LOG_CHANNEL(cellSpurs);
 
 // Temporarily
@@ -87,6 +91,216 @@ static s32 spursTasksetLoadElf(spu_thread& spu, u32* entryPoint, u32* lowestLoad
 bool spursJobChainEntry(spu_thread& spu);
 void spursJobchainPopUrgentCommand(spu_thread& spu);
 
+//----------------------------------------------------------------------------
+// SPURS scheduling telemetry
+//----------------------------------------------------------------------------
+
+// Records the scheduling decisions of the HLE SPURS kernel when "SPURS Telemetry" is enabled
+// On emulation stop the timeline is written to the cache directory as CSV and a summary per SPU is logged
+struct spurs_telemetry
+{
+	enum class event : u8
+	{
+		workload_switch, // arg: previous workload id
+		switch_request, // A poll found a better workload, arg: current workload id
+		contention, // Ready workloads refused because they reached their max contention, arg: workload bitset
+		idle_begin,
+		idle_end, // arg: number of waits
+		task_start, // id: task id, arg: taskset address
+		task_resume,
+		task_yield,
+		task_wait,
+		task_exit,
+	};
+
+	struct record
+	{
+		u64 time;
+		u32 spurs;
+		u8 spu;
+		event type;
+		u8 id; // Workload id, or task id for task events
+		u32 arg;
+	};
+
+	struct spu_stats
+	{
+		u64 last_switch = 0;
+		u64 idle_since = 0;
+		u32 wid = CELL_SPURS_SYS_SERVICE_WORKLOAD_ID;
+		u64 wkl_time = 0; // Time spent in workloads other than the system service
+		u64 sys_time = 0; // Time spent in the system service, including idle time
+		u64 idle_time = 0;
+		u64 switches = 0;
+		u64 switch_requests = 0;
+		u64 idle_waits = 0;
+		u64 contended = 0;
+		u64 tasks[5]{}; // Indexed by event - event::task_start
+	};
+
+	static constexpr usz max_records = 1u << 20;
+
+	const bool enabled = g_cfg.core.spurs_telemetry.get();
+
+	shared_mutex mutex;
+	std::vector<record> timeline;
+	std::map<u64, spu_stats> spus; // Key: SPURS address << 8 | SPU number
+	u64 dropped = 0;
+
+	// Requires the mutex
+	spu_stats& add(u64 now, u32 spurs, u32 spu, event type, u32 id, u32 arg)
+	{
+		if (timeline.size() < max_records)
+		{
+			timeline.push_back(record{now, spurs, static_cast<u8>(spu), type, static_cast<u8>(id), arg});
+		}
+		else
+		{
+			dropped++;
+		}
+
+		return spus[u64{spurs} << 8 | spu];
+	}
+
+	void on_select(const SpursKernelContext* ctxt, bool is_poll, u32 prev_wid, u32 wid, u32 contended)
+	{
+		if (wid == prev_wid && !contended)
+		{
+			return;
+		}
+
+		const u64 now = get_system_time();
+		const u32 spurs = ctxt->spurs.addr();
+		const u32 spu = ctxt->spuNum;
+
+		std::lock_guard lock(mutex);
+
+		if (contended)
+		{
+			add(now, spurs, spu, event::contention, wid, contended).contended++;
+		}
+
+		if (wid == prev_wid)
+		{
+			return;
+		}
+
+		if (is_poll)
+		{
+			add(now, spurs, spu, event::switch_request, wid, prev_wid).switch_requests++;
+			return;
+		}
+
+		auto& stats = add(now, spurs, spu, event::workload_switch, wid, prev_wid);
+
+		if (stats.last_switch)
+		{
+			(stats.wid == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID ? stats.sys_time : stats.wkl_time) += now - stats.last_switch;
+		}
+
+		stats.last_switch = now;
+		stats.wid = wid;
+		stats.switches++;
+	}
+
+	void on_idle(const SpursKernelContext* ctxt, u32 waits)
+	{
+		const u64 now = get_system_time();
+
+		std::lock_guard lock(mutex);
+
+		auto& stats = add(now, ctxt->spurs.addr(), ctxt->spuNum, waits ? event::idle_end : event::idle_begin, CELL_SPURS_SYS_SERVICE_WORKLOAD_ID, waits);
+
+		if (!waits)
+		{
+			stats.idle_since = now;
+		}
+		else if (stats.idle_since)
+		{
+			stats.idle_time += now - stats.idle_since;
+			stats.idle_waits += waits;
+			stats.idle_since = 0;
+		}
+	}
+
+	void on_task(const SpursKernelContext* ctxt, event type, u32 task_id, u32 taskset)
+	{
+		const u64 now = get_system_time();
+
+		std::lock_guard lock(mutex);
+
+		add(now, ctxt->spurs.addr(), ctxt->spuNum, type, task_id, taskset).tasks[static_cast<u8>(type) - static_cast<u8>(event::task_start)]++;
+	}
+
+	~spurs_telemetry()
+	{
+		if (timeline.empty())
+		{
+			return;
+		}
+
+		const u64 now = get_system_time();
+		const u64 start = timeline.front().time;
+
+		std::string csv = "time_us,spurs,spu,event,id,arg\n";
+		csv.reserve(timeline.size() * 40);
+
+		for (const record& r : timeline)
+		{
+			fmt::append(csv, "%u,0x%x,%u,%s,%u,0x%x\n", r.time - start, r.spurs, r.spu, r.type, r.id, r.arg);
+		}
+
+		const std::string path = fs::get_cache_dir() + "spurs_telemetry.csv";
+
+		if (fs::write_file(path, fs::rewrite, csv))
+		{
+			cellSpurs.notice("SPURS telemetry: %u events written to %s (%u dropped)", timeline.size(), path, dropped);
+		}
+		else
+		{
+			cellSpurs.error("SPURS telemetry: failed to write %s (%s)", path, fs::g_tls_error);
+		}
+
+		for (auto& [key, stats] : spus)
+		{
+			// Account for the workload running at stop
+			if (stats.last_switch)
+			{
+				(stats.wid == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID ? stats.sys_time : stats.wkl_time) += now - stats.last_switch;
+			}
+
+			const u64 total = std::max<u64>(stats.wkl_time + stats.sys_time, 1);
+
+			cellSpurs.notice("SPURS 0x%x SPU %u: busy %.1f%%, idle %.1f%% (%u waits), %u switches, %u switch requests, %u contended selections, tasks: %u started, %u resumed, %u yielded, %u waited, %u exited",
+				key >> 8, key & 0xff, stats.wkl_time * 100. / total, stats.idle_time * 100. / total, stats.idle_waits, stats.switches, stats.switch_requests, stats.contended,
+				stats.tasks[0], stats.tasks[1], stats.tasks[2], stats.tasks[3], stats.tasks[4]);
+		}
+	}
+};
+
+template <>
+void fmt_class_string<spurs_telemetry::event>::format(std::string& out, u64 arg)
+{
+	format_enum(out, arg, [](spurs_telemetry::event value)
+	{
+		switch (value)
+		{
+		case spurs_telemetry::event::workload_switch: return "switch";
+		case spurs_telemetry::event::switch_request: return "switch_request";
+		case spurs_telemetry::event::contention: return "contention";
+		case spurs_telemetry::event::idle_begin: return "idle_begin";
+		case spurs_telemetry::event::idle_end: return "idle_end";
+		case spurs_telemetry::event::task_start: return "task_start";
+		case spurs_telemetry::event::task_resume: return "task_resume";
+		case spurs_telemetry::event::task_yield: return "task_yield";
+		case spurs_telemetry::event::task_wait: return "task_wait";
+		case spurs_telemetry::event::task_exit: return "task_exit";
+		}
+
+		return unknown;
+	});
+}
+
 //----------------------------------------------------------------------------
 // SPURS utility functions
 //----------------------------------------------------------------------------
@@ -270,9 +484,11 @@ bool spursKernel1SelectWorkload(spu_thread& spu)
 	// is called by the SPURS kernel and set to true if called by cellSpursModulePollStatus.
 	// If the first argument is true then the shared data is not updated with the result.
 	const auto isPoll = spu.gpr[3]._u32[3];
+	const u32 wklPrevId = ctxt->wklCurrentId;
 
 	u32 wklSelectedId;
 	u32 pollStatus;
+	u32 wklContended = 0;
 
 	//vm::reservation_op(vm::cast(ctxt->spurs.addr()), 128, [&]()
 	{
@@ -363,6 +579,11 @@ bool spursKernel1SelectWorkload(spu_thread& spu)
 						}
 					}
 				}
+				else if (runnable && ctxt->priority[i] != 0 && (wklFlag || wklSignal || (readyCount != 0 && requestCount > contention[i])))
+				{
+					// Ready but already running on its max contention of SPUs
+					wklContended |= 0x80000000u >> i;
+				}
 			}
 
 			// Not sure what this does. Possibly mark the SPU as idle/in use.
@@ -439,6 +660,11 @@ bool spursKernel1SelectWorkload(spu_thread& spu)
 		std::memcpy(ctxt, spurs, 128);
 	}//);
 
+	if (auto& telemetry = g_fxo->get<spurs_telemetry>(); telemetry.enabled)
+	{
+		telemetry.on_select(ctxt, isPoll != 0, wklPrevId, wklSelectedId, wklContended);
+	}
+
 	u64 result = u64{wklSelectedId} << 32;
 	result |= pollStatus;
 	spu.gpr[3]._u64[1] = result;
@@ -454,9 +680,11 @@ bool spursKernel2SelectWorkload(spu_thread& spu)
 	// is called by the SPURS kernel and set to true if called by cellSpursModulePollStatus.
 	// If the first argument is true then the shared data is not updated with the result.
 	const auto isPoll = spu.gpr[3]._u32[3];
+	const u32 wklPrevId = ctxt->wklCurrentId;
 
 	u32 wklSelectedId;
 	u32 pollStatus;
+	u32 wklContended = 0;
 
 	//vm::reservation_op(vm::cast(ctxt->spurs.addr()), 128, [&]()
 	{
@@ -543,6 +771,11 @@ bool spursKernel2SelectWorkload(spu_thread& spu)
 						}
 					}
 				}
+				else if (runnable && priority > 0 && (wklFlag || wklSignal || readyCount > contention[i]))
+				{
+					// Ready but already running on its max contention of SPUs
+					wklContended |= 0x80000000u >> i;
+				}
 			}
 
 			// Not sure what this does. Possibly mark the SPU as idle/in use.
@@ -612,6 +845,11 @@ bool spursKernel2SelectWorkload(spu_thread& spu)
 		std::memcpy(ctxt, spurs, 128);
 	}//);
 
+	if (auto& telemetry = g_fxo->get<spurs_telemetry>(); telemetry.enabled)
+	{
+		telemetry.on_select(ctxt, isPoll != 0, wklPrevId, wklSelectedId, wklContended);
+	}
+
 	u64 result = u64{wklSelectedId} << 32;
 	result |= pollStatus;
 	spu.gpr[3]._u64[1] = result;
@@ -769,6 +1007,9 @@ bool spursSysServiceEntry(spu_thread& spu)
 void spursSysServiceIdleHandler(spu_thread& spu, SpursKernelContext* ctxt)
 {
 	bool shouldExit;
+	u32 idleWaits = 0;
+
+	auto& telemetry = g_fxo->get<spurs_telemetry>();
 
 	while (true)
 	{
@@ -857,6 +1098,12 @@ void spursSysServiceIdleHandler(spu_thread& spu, SpursKernelContext* ctxt)
 		if (spuIdling && shouldExit == false && foundReadyWorkload == false)
 		{
 			// The system service blocks by making a reservation and waiting on the lock line reservation lost event.
+			if (telemetry.enabled && idleWaits == 0)
+			{
+				telemetry.on_idle(ctxt, 0);
+			}
+
+			idleWaits++;
 			thread_ctrl::wait_for(1000);
 			continue;
 		}
@@ -867,6 +1114,11 @@ void spursSysServiceIdleHandler(spu_thread& spu, SpursKernelContext* ctxt)
 		}
 	}
 
+	if (telemetry.enabled && idleWaits)
+	{
+		telemetry.on_idle(ctxt, idleWaits);
+	}
+
 	if (shouldExit)
 	{
 		// TODO: exit spu thread group
@@ -1421,6 +1673,7 @@ s32 spursTasksetProcessRequest(spu_thread& spu, s32 request, u32* taskId, u32* i
 
 	s32 rc = CELL_OK;
 	s32 numNewlyReadyTasks = 0;
+	std::optional<spurs_telemetry::event> telemetryEvent;
 
 	//vm::reservation_op(vm::cast(ctxt->taskset.addr()), 128, [&]()
 	{
@@ -1464,6 +1717,7 @@ s32 spursTasksetProcessRequest(spu_thread& spu, s32 request, u32* taskId, u32* i
 		}
 		case SPURS_TASKSET_REQUEST_DESTROY_TASK:
 		{
+			telemetryEvent = spurs_telemetry::event::task_exit;
 			numNewlyReadyTasks--;
 			running._u &= ~ctxtTaskIdMask;
 			enabled._u &= ~ctxtTaskIdMask;
@@ -1473,6 +1727,7 @@ s32 spursTasksetProcessRequest(spu_thread& spu, s32 request, u32* taskId, u32* i
 		}
 		case SPURS_TASKSET_REQUEST_YIELD_TASK:
 		{
+			telemetryEvent = spurs_telemetry::event::task_yield;
 			running._u &= ~ctxtTaskIdMask;
 			waiting._u |= ctxtTaskIdMask;
 			break;
@@ -1481,6 +1736,7 @@ s32 spursTasksetProcessRequest(spu_thread& spu, s32 request, u32* taskId, u32* i
 		{
 			if (!(signalled0._u & ctxtTaskIdMask))
 			{
+				telemetryEvent = spurs_telemetry::event::task_wait;
 				numNewlyReadyTasks--;
 				running._u &= ~ctxtTaskIdMask;
 				waiting._u |= ctxtTaskIdMask;
@@ -1622,6 +1878,11 @@ s32 spursTasksetProcessRequest(spu_thread& spu, s32 request, u32* taskId, u32* i
 		});
 	}
 
+	if (auto& telemetry = g_fxo->get<spurs_telemetry>(); telemetry.enabled && telemetryEvent)
+	{
+		telemetry.on_task(kernelCtxt, *telemetryEvent, ctxt->taskId, ctxt->taskset.addr());
+	}
+
 	return rc;
 }
 
@@ -1757,6 +2018,11 @@ void spursTasksetDispatch(spu_thread& spu)
 
 	ctxt->taskId = taskId;
 
+	if (auto& telemetry = g_fxo->get<spurs_telemetry>(); telemetry.enabled)
+	{
+		telemetry.on_task(spu._ptr<SpursKernelContext>(0x100), isWaiting ? spurs_telemetry::event::task_resume : spurs_telemetry::event::task_start, taskId, ctxt->taskset.addr());
+	}
+
 	// DMA in the task info for the selected task
 	const auto taskInfo = spu._ptr<CellSpursTaskset::TaskInfo>(0x2780);
 	std::memcpy(taskInfo, &ctxt->taskset->task_info[taskId], sizeof(CellSpursTaskset::TaskInfo));
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Emu/IdManager.h"
 #include "Emu/perf_meter.hpp"
+#include "Emu/system_config.h"
 #include "Emu/Cell/PPUModule.h"
 #include "Emu/Cell/lv2/sys_sync.h"
 #include "Emu/Cell/lv2/sys_ppu_thread.h"
@@ -8,6 +9,7 @@
 #include "sysPrxForUser.h"
 #include "util/media_utils.h"
 #include "util/init_mutex.hpp"
+#include "util/sysinfo.hpp"
 
 #ifdef _MSC_VER
 #pragma warning(push, 0)
@@ -21,6 +23,7 @@ extern "C"
 {
 #include "libavcodec/avcodec.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
 #include "libswscale/swscale.h"
 }
 #ifdef _MSC_VER
@@ -169,6 +172,152 @@ struct vdec_frame
 	}
 };
 
+// Colour conversion of pictures split into horizontal bands, which are converted concurrently
+// The calling thread converts the first band and returns once the whole picture is written
+struct vdec_scaler
+{
+	// Bands smaller than this are not worth a thread wakeup
+	static constexpr int min_band_height = 64;
+
+	struct band
+	{
+		SwsContext* sws{};
+		AVPixelFormat in_f{};
+		AVPixelFormat out_f{};
+		int w = 0;
+		int h = 0;
+		std::array<const u8*, 4> in_data{};
+		std::array<int, 4> in_line{};
+		std::array<u8*, 4> out_data{};
+		std::array<int, 4> out_line{};
+
+		band() = default;
+
+		band(const band&) = delete;
+
+		band& operator=(const band&) = delete;
+
+		~band()
+		{
+			sws_freeContext(sws);
+		}
+
+		void convert()
+		{
+			// Point sampling without resizing, so each band gives the same result as the full picture
+			sws = sws_getCachedContext(sws, w, h, in_f, w, h, out_f, SWS_POINT, nullptr, nullptr, nullptr);
+
+			if (!sws)
+			{
+				fmt::throw_exception("sws_getCachedContext() failed (w=%d, h=%d, in_f=%d, out_f=%d)", w, h, +in_f, +out_f);
+			}
+
+			sws_scale(sws, in_data.data(), in_line.data(), 0, h, out_data.data(), out_line.data());
+		}
+	};
+
+	struct worker : band
+	{
+		atomic_t<u32> job_id = 0;
+		atomic_t<u32>* remaining = nullptr;
+
+		void operator()()
+		{
+			for (u32 done = 0; thread_ctrl::state() != thread_state::aborting;)
+			{
+				const u32 id = job_id;
+
+				if (id == done)
+				{
+					thread_ctrl::wait_on(job_id, id);
+					continue;
+				}
+
+				convert();
+				done = id;
+
+				if (!--*remaining)
+				{
+					remaining->notify_one();
+				}
+			}
+		}
+	};
+
+	std::mutex mutex;
+	band first;
+	atomic_t<u32> remaining = 0;
+	named_thread_group<worker> workers;
+
+	vdec_scaler(u32 worker_count)
+		: workers("VDEC Scaler ", worker_count)
+	{
+		for (auto& w : workers)
+		{
+			w.remaining = &remaining;
+		}
+	}
+
+	void convert(AVPixelFormat in_f, AVPixelFormat out_f, int w, int h, u8* const in_data[4], const int in_line[4], u8* const out_data[4], const int out_line[4])
+	{
+		std::lock_guard lock(mutex);
+
+		const AVPixFmtDescriptor* in_desc = av_pix_fmt_desc_get(in_f);
+		const AVPixFmtDescriptor* out_desc = av_pix_fmt_desc_get(out_f);
+
+		// Row of a plane at picture row y (planes 1 and 2 are the chroma planes of planar formats)
+		const auto plane_row = [](const AVPixFmtDescriptor* desc, int plane, int y)
+		{
+			return plane == 1 || plane == 2 ? y >> desc->log2_chroma_h : y;
+		};
+
+		// Bands start on even rows so that 4:2:0 chroma rows are not split
+		const int count = std::clamp<int>(h / min_band_height, 1, workers.size() + 1);
+		const int band_h = ((h + count - 1) / count + 1) & ~1;
+
+		u32 used = 0;
+
+		for (int y = 0; y < h; y += band_h, used++)
+		{
+			band& b = used ? *(workers.begin() + (used - 1)) : first;
+
+			b.in_f = in_f;
+			b.out_f = out_f;
+			b.w = w;
+			b.h = std::min(band_h, h - y);
+
+			for (int p = 0; p < 4; p++)
+			{
+				b.in_data[p] = in_data[p] ? in_data[p] + in_line[p] * plane_row(in_desc, p, y) : nullptr;
+				b.in_line[p] = in_line[p];
+				b.out_data[p] = out_data[p] ? out_data[p] + out_line[p] * plane_row(out_desc, p, y) : nullptr;
+				b.out_line[p] = out_line[p];
+			}
+		}
+
+		remaining = used - 1;
+
+		for (u32 i = 1; i < used; i++)
+		{
+			auto& w = *(workers.begin() + (i - 1));
+			w.job_id++;
+			w.job_id.notify_one();
+		}
+
+		first.convert();
+
+		while (const u32 left = remaining)
+		{
+			if (thread_ctrl::state() == thread_state::aborting)
+			{
+				break;
+			}
+
+			thread_ctrl::wait_on(remaining, left);
+		}
+	}
+};
+
 struct vdec_context final
 {
 	static const u32 id_base = 0xf0000000;
@@ -186,7 +335,7 @@ struct vdec_context final
 
 	const AVCodec* codec{};
 	AVCodecContext* ctx{};
-	SwsContext* sws{};
+	std::unique_ptr<vdec_scaler> scaler;
 
 	shared_mutex mutex; // Used for 'out' queue (TODO)
 
@@ -200,6 +349,17 @@ struct vdec_context final
 	u32 frc_set{}; // Frame Rate Override
 	u64 next_pts{};
 	u64 next_dts{};
+
+	// User data and attributes of the AUs sent to the decoder, by command ID
+	// With frame threading or reordering the frames don't come out of the decoder with the AU that produced them
+	struct au_info
+	{
+		u64 userdata;
+		CellVdecPicAttr attr;
+	};
+
+	std::map<u64, au_info> au_infos;
+	static constexpr usz au_info_max = 64;
 	atomic_t<u32> ppu_tid{};
 
 	std::deque<vdec_frame> out_queue;
@@ -253,6 +413,17 @@ struct vdec_context final
 			fmt::throw_exception("avcodec_alloc_context3() failed (type=0x%x)", type);
 		}
 
+		// Slice threading has no latency, frame threading delays the output by one frame per thread
+		// A thread count of 0 lets FFmpeg pick one based on the host CPU
+		const u32 threads = g_cfg.video.vdec_threads;
+		ctx->thread_count = threads;
+		ctx->thread_type = FF_THREAD_SLICE | (g_cfg.video.vdec_frame_threading ? FF_THREAD_FRAME : 0);
+
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+		// Pass the AU command ID from the packet to the frames it produces
+		ctx->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+#endif
+
 		AVDictionary* opts = nullptr;
 
 		std::lock_guard lock(g_mutex_avcodec_open2);
@@ -275,6 +446,11 @@ struct vdec_context final
 
 		av_dict_free(&opts);
 
+		cellVdec.notice("Video decoder opened (type=0x%x, thread_count=%d, thread_type=%d)", type, ctx->thread_count, ctx->active_thread_type);
+
+		const u32 scaler_threads = threads ? threads : std::clamp<u32>(utils::get_thread_count() / 2, 1, 4);
+		scaler = std::make_unique<vdec_scaler>(scaler_threads - 1);
+
 		seq_state = sequence_state::dormant;
 	}
 
@@ -282,7 +458,201 @@ struct vdec_context final
 	{
 		avcodec_close(ctx);
 		avcodec_free_context(&ctx);
-		sws_freeContext(sws);
+	}
+
+	// Receive all frames available after the last packet
+	void receive_frames(const vdec_cmd& cmd, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!abort_decode && seq_id == cmd.seq_id)
+		{
+			// Keep receiving frames
+			vdec_frame frame;
+			frame.seq_id = cmd.seq_id;
+			frame.cmd_id = cmd.id;
+			frame.avf.reset(av_frame_alloc());
+
+			if (!frame.avf)
+			{
+				fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			}
+
+			if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
+			{
+				if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
+				{
+					break;
+				}
+
+				fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd.seq_id, cmd.id, ret, utils::av_error_to_string(ret));
+			}
+
+			if (frame->interlaced_frame)
+			{
+				// NPEB01838, NPUB31260
+				cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, interlaced_frame=0x%x)", handle, cmd.seq_id, cmd.id, frame->interlaced_frame);
+			}
+
+			if (frame->repeat_pict)
+			{
+				fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd.seq_id, cmd.id, frame->repeat_pict);
+			}
+
+			if (frame->pts != smin)
+			{
+				next_pts = frame->pts;
+			}
+
+			if (frame->pkt_dts != smin)
+			{
+				next_dts = frame->pkt_dts;
+			}
+
+			frame.pts = next_pts;
+			frame.dts = next_dts;
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+			const u64 au_id = reinterpret_cast<uptr>(frame->opaque);
+#else
+			const u64 au_id = frame->reordered_opaque;
+#endif
+
+			if (const auto found = au_infos.find(au_id); found != au_infos.end())
+			{
+				frame.userdata = found->second.userdata;
+				frame.attr = found->second.attr;
+			}
+			else
+			{
+				cellVdec.warning("Frame of unknown AU (handle=0x%x, seq_id=%d, cmd_id=%d, au_id=%d)", handle, cmd.seq_id, cmd.id, au_id);
+				frame.userdata = 0;
+				frame.attr = CELL_VDEC_PICITEM_ATTR_NORMAL;
+			}
+
+			if (frc_set)
+			{
+				u64 amend = 0;
+
+				switch (frc_set)
+				{
+				case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
+				case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
+				case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
+				case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
+				case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
+				case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
+				case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
+				case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
+				default:
+				{
+					fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd.seq_id, cmd.id, frc_set);
+				}
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+				frame.frc = frc_set;
+			}
+			else if (ctx->time_base.num == 0)
+			{
+				if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+				{
+					cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+					log_time_base = ctx->time_base;
+				}
+
+				// Hack
+				const u64 amend = u64{90000} / 30;
+				frame.frc = CELL_VDEC_FRC_30;
+				next_pts += amend;
+				next_dts += amend;
+			}
+			else
+			{
+				u64 amend = u64{90000} * ctx->time_base.num * ctx->ticks_per_frame / ctx->time_base.den;
+				const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ctx->ticks_per_frame;
+
+				if (std::abs(freq - 23.976) < 0.002)
+					frame.frc = CELL_VDEC_FRC_24000DIV1001;
+				else if (std::abs(freq - 24.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_24;
+				else if (std::abs(freq - 25.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_25;
+				else if (std::abs(freq - 29.970) < 0.002)
+					frame.frc = CELL_VDEC_FRC_30000DIV1001;
+				else if (std::abs(freq - 30.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_30;
+				else if (std::abs(freq - 50.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_50;
+				else if (std::abs(freq - 59.940) < 0.002)
+					frame.frc = CELL_VDEC_FRC_60000DIV1001;
+				else if (std::abs(freq - 60.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_60;
+				else
+				{
+					if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+					{
+						// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
+						cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+						log_time_base = ctx->time_base;
+					}
+
+					// Hack
+					amend = u64{90000} / 30;
+					frame.frc = CELL_VDEC_FRC_30;
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+			}
+
+			cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd.seq_id, cmd.id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
+
+			decoded_frames.push_back(std::move(frame));
+		}
+	}
+
+	// Move decoded frames to the image queue, waiting for the consumer when it's full
+	void output_frames(ppu_thread& ppu, u32 vid, const vdec_cmd& cmd, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!decoded_frames.empty() && seq_id == cmd.seq_id)
+		{
+			// Wait until there is free space in the image queue.
+			// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
+			u32 elapsed = 0;
+			while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd.seq_id)
+			{
+				{
+					std::lock_guard lock{mutex};
+
+					if (out_queue.size() <= out_max)
+					{
+						break;
+					}
+				}
+
+				thread_ctrl::wait_for(10000);
+
+				if (elapsed++ >= 500) // 5 seconds
+				{
+					cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd.seq_id, cmd.id, out_queue.size());
+					elapsed = 0;
+				}
+			}
+
+			if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd.seq_id)
+			{
+				break;
+			}
+
+			{
+				std::lock_guard lock{mutex};
+				out_queue.push_back(std::move(decoded_frames.front()));
+				decoded_frames.pop_front();
+			}
+
+			cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
+			lv2_obj::sleep(ppu);
+		}
 	}
 
 	void exec(ppu_thread& ppu, u32 vid)
@@ -333,6 +703,7 @@ struct vdec_context final
 				avcodec_flush_buffers(ctx);
 
 				out_queue.clear(); // Flush image queue
+				au_infos.clear();
 				log_time_base = {};
 				au_count = 0;
 
@@ -348,6 +719,26 @@ struct vdec_context final
 			{
 				cellVdec.trace("End sequence... (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
 
+				if (ctx->active_thread_type & FF_THREAD_FRAME)
+				{
+					// Frame threading holds back up to one frame per thread, output them before SEQDONE
+					std::deque<vdec_frame> decoded_frames;
+
+					if (!abort_decode && seq_id == cmd->seq_id)
+					{
+						if (int ret = avcodec_send_packet(ctx, nullptr); ret < 0 && ret != AVERROR_EOF)
+						{
+							fmt::throw_exception("AU drain error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
+						}
+
+						receive_frames(*cmd, decoded_frames);
+						output_frames(ppu, vid, *cmd, decoded_frames);
+					}
+
+					// Leave the draining mode
+					avcodec_flush_buffers(ctx);
+				}
+
 				{
 					std::lock_guard lock{mutex};
 					seq_state = sequence_state::dormant;
@@ -376,6 +767,11 @@ struct vdec_context final
 				packet.size = au_size;
 				packet.pts = au_pts != umax ? au_pts : s64{smin};
 				packet.dts = au_dts != umax ? au_dts : s64{smin};
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+				packet.opaque = reinterpret_cast<void*>(static_cast<uptr>(cmd->id));
+#else
+				ctx->reordered_opaque = cmd->id;
+#endif
 
 				if (next_pts == 0 && au_pts != umax)
 				{
@@ -393,6 +789,14 @@ struct vdec_context final
 					au_mode == CELL_VDEC_DEC_MODE_NORMAL ? AVDISCARD_DEFAULT :
 					au_mode == CELL_VDEC_DEC_MODE_B_SKIP ? AVDISCARD_NONREF : AVDISCARD_NONINTRA;
 
+				au_infos.insert_or_assign(cmd->id, au_info{au_usrd, attr});
+
+				if (au_infos.size() > au_info_max)
+				{
+					// Forget the oldest AU, its frames were output or discarded long ago
+					au_infos.erase(au_infos.begin());
+				}
+
 				std::deque<vdec_frame> decoded_frames;
 
 				if (!abort_decode && seq_id == cmd->seq_id)
@@ -404,136 +808,7 @@ struct vdec_context final
 						fmt::throw_exception("AU queuing error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
 					}
 
-					while (!abort_decode && seq_id == cmd->seq_id)
-					{
-						// Keep receiving frames
-						vdec_frame frame;
-						frame.seq_id = cmd->seq_id;
-						frame.cmd_id = cmd->id;
-						frame.avf.reset(av_frame_alloc());
-
-						if (!frame.avf)
-						{
-							fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						}
-
-						if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
-						{
-							if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
-							{
-								break;
-							}
-
-							fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
-						}
-
-						if (frame->interlaced_frame)
-						{
-							// NPEB01838, NPUB31260
-							cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, interlaced_frame=0x%x)", handle, cmd->seq_id, cmd->id, frame->interlaced_frame);
-						}
-
-						if (frame->repeat_pict)
-						{
-							fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd->seq_id, cmd->id, frame->repeat_pict);
-						}
-
-						if (frame->pts != smin)
-						{
-							next_pts = frame->pts;
-						}
-
-						if (frame->pkt_dts != smin)
-						{
-							next_dts = frame->pkt_dts;
-						}
-
-						frame.pts = next_pts;
-						frame.dts = next_dts;
-						frame.userdata = au_usrd;
-						frame.attr = attr;
-
-						if (frc_set)
-						{
-							u64 amend = 0;
-
-							switch (frc_set)
-							{
-							case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
-							case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
-							case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
-							case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
-							case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
-							case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
-							case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
-							case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
-							default:
-							{
-								fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd->seq_id, cmd->id, frc_set);
-							}
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-							frame.frc = frc_set;
-						}
-						else if (ctx->time_base.num == 0)
-						{
-							if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-							{
-								cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-								log_time_base = ctx->time_base;
-							}
-
-							// Hack
-							const u64 amend = u64{90000} / 30;
-							frame.frc = CELL_VDEC_FRC_30;
-							next_pts += amend;
-							next_dts += amend;
-						}
-						else
-						{
-							u64 amend = u64{90000} * ctx->time_base.num * ctx->ticks_per_frame / ctx->time_base.den;
-							const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ctx->ticks_per_frame;
-
-							if (std::abs(freq - 23.976) < 0.002)
-								frame.frc = CELL_VDEC_FRC_24000DIV1001;
-							else if (std::abs(freq - 24.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_24;
-							else if (std::abs(freq - 25.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_25;
-							else if (std::abs(freq - 29.970) < 0.002)
-								frame.frc = CELL_VDEC_FRC_30000DIV1001;
-							else if (std::abs(freq - 30.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_30;
-							else if (std::abs(freq - 50.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_50;
-							else if (std::abs(freq - 59.940) < 0.002)
-								frame.frc = CELL_VDEC_FRC_60000DIV1001;
-							else if (std::abs(freq - 60.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_60;
-							else
-							{
-								if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-								{
-									// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
-									cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-									log_time_base = ctx->time_base;
-								}
-
-								// Hack
-								amend = u64{90000} / 30;
-								frame.frc = CELL_VDEC_FRC_30;
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-						}
-
-						cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd->seq_id, cmd->id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
-
-						decoded_frames.push_back(std::move(frame));
-					}
+					receive_frames(*cmd, decoded_frames);
 				}
 
 				if (thread_ctrl::state() != thread_state::aborting)
@@ -548,46 +823,7 @@ struct vdec_context final
 						--au_count;
 					}
 
-					while (!decoded_frames.empty() && seq_id == cmd->seq_id)
-					{
-						// Wait until there is free space in the image queue.
-						// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
-						u32 elapsed = 0;
-						while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd->seq_id)
-						{
-							{
-								std::lock_guard lock{mutex};
-
-								if (out_queue.size() <= out_max)
-								{
-									break;
-								}
-							}
-
-							thread_ctrl::wait_for(10000);
-
-							if (elapsed++ >= 500) // 5 seconds
-							{
-								cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd->seq_id, cmd->id, out_queue.size());
-								elapsed = 0;
-							}
-						}
-
-						if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd->seq_id)
-						{
-							break;
-						}
-
-						{
-							std::lock_guard lock{mutex};
-							out_queue.push_back(std::move(decoded_frames.front()));
-							decoded_frames.pop_front();
-						}
-
-						cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
-						lv2_obj::sleep(ppu);
-					}
+					output_frames(ppu, vid, *cmd, decoded_frames);
 				}
 
 				if (abort_decode || seq_id != cmd->seq_id)
@@ -1297,8 +1533,6 @@ error_code cellVdecGetPictureExt(ppu_thread& ppu, u32 handle, vm::cptr<CellVdecP
 
 		cellVdec.trace("cellVdecGetPictureExt: handle=0x%x, seq_id=%d, cmd_id=%d, w=%d, h=%d, frameFormat=%d, formatType=%d, in_f=%d, out_f=%d, alpha_plane=%d, alpha=%d, colorMatrixType=%d", handle, frame.seq_id, frame.cmd_id, w, h, frame->format, format->formatType, +in_f, +out_f, !!alpha_plane, format->alpha, format->colorMatrixType);
 
-		vdec->sws = sws_getCachedContext(vdec->sws, w, h, in_f, w, h, out_f, SWS_POINT, nullptr, nullptr, nullptr);
-
 		u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha_plane.get() };
 		int in_line[4] = { frame->linesize[0], frame->linesize[1], frame->linesize[2], w * 1 };
 		u8* out_data[4] = { outBuff.get_ptr() };
@@ -1316,7 +1550,7 @@ error_code cellVdecGetPictureExt(ppu_thread& ppu, u32 handle, vm::cptr<CellVdecP
 			}
 		}
 
-		sws_scale(vdec->sws, in_data, in_line, 0, h, out_data, out_line);
+		vdec->scaler->convert(in_f, out_f, w, h, in_data, in_line, out_data, out_line);
 
 		//const u32 buf_size = utils::align(av_image_get_buffer_size(vdec->ctx->pix_fmt, vdec->ctx->width, vdec->ctx->height, 1), 128);
 
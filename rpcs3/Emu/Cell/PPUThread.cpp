@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Utilities/JIT.h"
 #include "Utilities/StrUtil.h"
+#include "Utilities/job_system.h"
 #include "util/serialization.hpp"
 #include "Crypto/sha1.h"
 #include "Crypto/unself.h"
@@ -3051,7 +3052,10 @@ extern void ppu_precompile(std::vector<std::string>& dir_queue, std::vector<ppu_
 
 	shared_mutex sprx_mtx, ovl_mtx;
 
-	named_thread_group workers("SPRX Worker ", std::min<u32>(utils::get_thread_count(), ::size32(file_queue)), [&]
+	// Building caches ahead of time yields to compilation the running game waits for
+	const auto compile_class = loaded_modules ? utils::job_class::foreground : utils::job_class::background;
+
+	utils::run_jobs(compile_class, std::min<u32>(utils::get_job_budget(), ::size32(file_queue)), [&](u32)
 	{
 #ifdef __APPLE__
 		pthread_jit_write_protect_np(false);
@@ -3162,9 +3166,6 @@ extern void ppu_precompile(std::vector<std::string>& dir_queue, std::vector<ppu_
 		}
 	});
 
-	// Join every thread
-	workers.join();
-
 	// Revert changes
 
 	if (!had_ovl)
@@ -3768,7 +3769,7 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 		g_progr = "Compiling PPU modules...";
 	}
 
-	// Create worker threads for compilation (TODO: how many threads)
+	// Run compilation jobs on the shared worker pool
 	{
 		u32 thread_count = rpcs3::utils::get_max_threads();
 
@@ -3777,15 +3778,10 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 			thread_count = ::size32(workload);
 		}
 
-		struct thread_index_allocator
-		{
-			atomic_t<u64> index = 0;
-		};
-
 		// Prevent watchdog thread from terminating
 		g_watchdog_hold_ctr++;
 
-		named_thread_group threads(fmt::format("PPUW.%u.", ++g_fxo->get<thread_index_allocator>().index), thread_count, [&]()
+		utils::run_jobs(utils::job_class::foreground, thread_count, [&](u32)
 		{
 			// Set low priority
 			thread_ctrl::scoped_priority low_prio(-1);
@@ -3818,11 +3814,12 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 				ppu_initialize2(jit2, part, cache_path, obj_name);
 
 				ppu_log.success("LLVM: Compiled module %s", obj_name);
+
+				// Let more urgent work through between modules
+				utils::job_yield();
 			}
 		});
 
-		threads.join();
-
 		g_watchdog_hold_ctr--;
 
 		if (Emu.IsStopped() || !get_current_cpu_thread())
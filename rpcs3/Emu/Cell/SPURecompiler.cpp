@@ -11,6 +11,7 @@
 #include "Crypto/sha1.h"
 #include "Utilities/StrUtil.h"
 #include "Utilities/JIT.h"
+#include "Utilities/job_system.h"
 #include "util/init_mutex.hpp"
 #include "util/shared_ptr.hpp"
 
@@ -655,7 +656,7 @@ void spu_cache::initialize()
 		worker_count = rpcs3::utils::get_max_threads();
 	}
 
-	named_thread_group workers("SPU Worker ", worker_count, [&]() -> uint
+	const auto build_worker = [&]() -> uint
 	{
 #ifdef __APPLE__
 		pthread_jit_write_protect_np(false);
@@ -742,15 +743,26 @@ void spu_cache::initialize()
 			std::memset(ls.data() + start / 4, 0, 4 * (size0 - 1));
 
 			result++;
+
+			// Let more urgent work through between functions
+			utils::job_yield();
 		}
 
 		return result;
+	};
+
+	// Run the workers as jobs on the shared pool
+	std::vector<uint> worker_results(worker_count);
+
+	utils::run_jobs(utils::job_class::foreground, worker_count, [&](u32 index)
+	{
+		worker_results[index] = build_worker();
 	});
 
-	// Join (implicitly) and print individual results
-	for (u32 i = 0; i < workers.size(); i++)
+	// Print individual results
+	for (u32 i = 0; i < worker_count; i++)
 	{
-		spu_log.notice("SPU Runtime: Worker %u built %u programs.", i + 1, workers[i]);
+		spu_log.notice("SPU Runtime: Worker %u built %u programs.", i + 1, worker_results[i]);
 	}
 
 	if (Emu.IsStopped())
@@ -10675,6 +10687,9 @@ struct spu_llvm_worker
 
 			const auto& func = *prog->second;
 
+			// Count against the process-wide compilation budget
+			utils::job_slot slot(utils::job_class::foreground);
+
 			// Get data start
 			const u32 start = func.lower_bound;
 			const u32 size0 = ::size32(func.data);
@@ -12,6 +12,7 @@
 #include "Emu/IdManager.h"
 #include "Emu/system_utils.hpp"
 #include "Emu/Cell/lv2/sys_process.h"
+#include "Emu/RSX/Common/write_tracking.h"
 #include "Utilities/StrUtil.h"
 
 #include <span>
@@ -338,13 +339,42 @@ lv2_fs_object::lv2_fs_object(utils::serial& ar, bool)
 {
 }
 
+bool lv2_file::can_transfer_direct(u32 addr, u64 size, bool is_write)
+{
+	if (size <= 4096 || u64{addr} + size > 0x1'0000'0000)
+	{
+		// Small requests do not benefit from it
+		return false;
+	}
+
+	return vm::check_addr(addr, is_write ? vm::page_readable : vm::page_writable, static_cast<u32>(size)) &&
+		rsx::write_tracking::is_range_unprotected(addr, static_cast<u32>(size));
+}
+
 u64 lv2_file::op_read(const fs::file& file, vm::ptr<void> buf, u64 size)
 {
+	u64 result = 0;
+
+	if (can_transfer_direct(buf.addr(), size, false))
+	{
+		// Read straight into guest memory, large requests are split across the asynchronous I/O engine
+		const u64 pos = file.pos();
+		result = size >= 0x100000
+			? g_fxo->get<lv2_fs_aio>().get().transfer(file.get_handle(), pos, buf.get_ptr(), size, false)
+			: fs::native_transfer(file.get_handle(), pos, buf.get_ptr(), size, false);
+		file.seek(pos + result);
+
+		if (result == size || pos + result >= file.size())
+		{
+			return result;
+		}
+
+		// Part of the destination got locked in the meantime, finish through the intermediate buffer
+	}
+
 	// Copy data from intermediate buffer (avoid passing vm pointer to a native API)
 	uchar local_buf[65536];
 
-	u64 result = 0;
-
 	while (result < size)
 	{
 		const u64 block = std::min<u64>(size - result, sizeof(local_buf));
@@ -364,11 +394,24 @@ u64 lv2_file::op_read(const fs::file& file, vm::ptr<void> buf, u64 size)
 
 u64 lv2_file::op_write(const fs::file& file, vm::cptr<void> buf, u64 size)
 {
+	u64 result = 0;
+
+	if (can_transfer_direct(buf.addr(), size, true))
+	{
+		// Write straight from guest memory in a single request
+		const u64 pos = file.pos();
+		result = fs::native_transfer(file.get_handle(), pos, const_cast<void*>(buf.get_ptr()), size, true);
+		file.seek(pos + result);
+
+		if (result == size)
+		{
+			return result;
+		}
+	}
+
 	// Copy data to intermediate buffer (avoid passing vm pointer to a native API)
 	uchar local_buf[65536];
 
-	u64 result = 0;
-
 	while (result < size)
 	{
 		const u64 block = std::min<u64>(size - result, sizeof(local_buf));
@@ -610,6 +653,24 @@ struct lv2_file::file_view : fs::file_base
 	}
 };
 
+fs::aio_engine& lv2_fs_aio::get()
+{
+	if (fs::aio_engine* engine = m_engine_ptr)
+	{
+		return *engine;
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	if (!m_engine)
+	{
+		m_engine = fs::make_aio_engine(64, 4);
+		m_engine_ptr = m_engine.get();
+	}
+
+	return *m_engine;
+}
+
 fs::file lv2_file::make_view(const std::shared_ptr<lv2_file>& _file, u64 offset)
 {
 	fs::file result;
@@ -691,7 +752,9 @@ lv2_file::open_raw_result_t lv2_file::open_raw(const std::string& local_path, s3
 {
 	// TODO: other checks for path
 
-	if (fs::is_dir(local_path))
+	fs::stat_t info{};
+
+	if (vfs::host::stat(local_path, info, mp) && info.is_directory)
 	{
 		return {CELL_EISDIR};
 	}
@@ -1192,6 +1255,12 @@ error_code sys_fs_close(ppu_thread& ppu, u32 fd)
 			}
 		}
 
+		// Wait for cellFsAio requests still using the host file handle (they are registered under the mount point lock)
+		while (const u32 pending = file->aio_pending)
+		{
+			file->aio_pending.wait(pending);
+		}
+
 		// Ensure Host file handle won't be kept open after this syscall
 		file->file.close();
 	}
@@ -1420,7 +1489,7 @@ error_code sys_fs_stat(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<CellFsStat>
 
 	fs::stat_t info{};
 
-	if (!fs::stat(local_path, info))
+	if (!vfs::host::stat(local_path, info, mp))
 	{
 		switch (auto error = fs::g_tls_error)
 		{
@@ -1431,7 +1500,7 @@ error_code sys_fs_stat(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<CellFsStat>
 
 			for (u32 i = 66601; i <= 66699; i++)
 			{
-				if (fs::stat(fmt::format("%s.%u", local_path, i), info) && !info.is_directory)
+				if (vfs::host::stat(fmt::format("%s.%u", local_path, i), info, mp) && !info.is_directory)
 				{
 					total_size += info.size;
 				}
@@ -1442,7 +1511,7 @@ error_code sys_fs_stat(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<CellFsStat>
 			}
 
 			// Use attributes from the first fragment (consistently with sys_fs_open+fstat)
-			if (fs::stat(local_path + ".66600", info) && !info.is_directory)
+			if (vfs::host::stat(local_path + ".66600", info, mp) && !info.is_directory)
 			{
 				// Success
 				info.size += total_size;
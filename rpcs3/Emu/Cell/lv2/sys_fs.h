@@ -3,6 +3,7 @@
 #include "Emu/Memory/vm_ptr.h"
 #include "Emu/Cell/ErrorCodes.h"
 #include "Utilities/File.h"
+#include "Utilities/async_io.h"
 
 #include <string>
 #include <mutex>
@@ -227,6 +228,9 @@ struct lv2_file final : lv2_fs_object
 	// Stream lock
 	atomic_t<u32> lock{0};
 
+	// Asynchronous requests in progress on the host file handle
+	atomic_t<u32> aio_pending{0};
+
 	// Some variables for convinience of data restoration
 	struct save_restore_t
 	{
@@ -277,7 +281,10 @@ struct lv2_file final : lv2_fs_object
 	static open_raw_result_t open_raw(const std::string& path, s32 flags, s32 mode, lv2_file_type type = lv2_file_type::regular, const lv2_fs_mount_point* mp = nullptr);
 	static open_result_t open(std::string_view vpath, s32 flags, s32 mode, const void* arg = {}, u64 size = 0);
 
-	// File reading with intermediate buffer
+	// Test whether the guest range can be handed directly to the host OS
+	static bool can_transfer_direct(u32 addr, u64 size, bool is_write);
+
+	// File reading, directly into guest memory when possible, otherwise with intermediate buffer
 	static u64 op_read(const fs::file& file, vm::ptr<void> buf, u64 size);
 
 	u64 op_read(vm::ptr<void> buf, u64 size) const
@@ -285,7 +292,7 @@ struct lv2_file final : lv2_fs_object
 		return op_read(file, buf, size);
 	}
 
-	// File writing with intermediate buffer
+	// File writing, directly from guest memory when possible, otherwise with intermediate buffer
 	static u64 op_write(const fs::file& file, vm::cptr<void> buf, u64 size);
 
 	u64 op_write(vm::cptr<void> buf, u64 size) const
@@ -566,6 +573,17 @@ struct CellFsMountInfo
 
 CHECK_SIZE(CellFsMountInfo, 0x94);
 
+// Host asynchronous I/O engine shared by sys_fs and cellFsAio, created on first use
+struct lv2_fs_aio
+{
+	fs::aio_engine& get();
+
+private:
+	shared_mutex m_mutex;
+	std::unique_ptr<fs::aio_engine> m_engine;
+	atomic_t<fs::aio_engine*> m_engine_ptr{};
+};
+
 // Default IO container
 struct default_sys_fs_container
 {
@@ -105,6 +105,7 @@ void _sys_ppu_thread_exit(ppu_thread& ppu, u64 errorcode)
 		if (old_status != ppu_join_status::joinable)
 		{
 			// Remove self ID from IDM, move owning ptr
+			std::lock_guard map_lock(idm::get_map_mutex<named_thread<ppu_thread>>());
 			old_ppu = g_fxo->get<ppu_thread_cleaner>().clean(std::move(idm::find_unlocked<named_thread<ppu_thread>>(ppu.id)->second));
 		}
 
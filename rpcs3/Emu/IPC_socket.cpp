@@ -3,6 +3,7 @@
 #include "Emu/IPC_config.h"
 #include "IPC_socket.h"
 #include "rpcs3_version.h"
+#include "Emu/RSX/RSXThread.h"
 
 
 namespace IPC_socket
@@ -47,6 +48,43 @@ namespace IPC_socket
 		vm::write64(addr, value);
 	}
 
+	bool IPC_impl::read_bytes(u32 addr, u32 size, char* dst)
+	{
+		if (!vm::check_addr(addr, vm::page_readable, size))
+		{
+			return false;
+		}
+
+		std::memcpy(dst, vm::base(addr), size);
+		return true;
+	}
+
+	bool IPC_impl::write_bytes(u32 addr, u32 size, const char* src)
+	{
+		if (!vm::check_addr(addr, vm::page_writable, size))
+		{
+			return false;
+		}
+
+		std::memcpy(vm::base(addr), src, size);
+		return true;
+	}
+
+	void IPC_impl::wait_vblank()
+	{
+		if (Emu.IsRunning())
+		{
+			if (const auto render = rsx::get_current_renderer())
+			{
+				const u64 old = render->vblank_count;
+				render->vblank_count.wait(old, atomic_wait_timeout{100'000'000});
+				return;
+			}
+		}
+
+		thread_ctrl::wait_for(16'666);
+	}
+
 	int IPC_impl::get_port()
 	{
 		return g_cfg_ipc.get_port();
@@ -18,6 +18,11 @@ namespace IPC_socket
 			return vm::check_addr<Size>(addr, flags);
 		}
 
+		static bool check_addr(u32 addr, u8 flags, u32 size)
+		{
+			return vm::check_addr(addr, flags, size);
+		}
+
 		static const u8& read8(u32 addr);
 		static void write8(u32 addr, u8 value);
 		static const be_t<u16>& read16(u32 addr);
@@ -27,6 +32,13 @@ namespace IPC_socket
 		static const be_t<u64>& read64(u32 addr);
 		static void write64(u32 addr, be_t<u64> value);
 
+		// Copy a range of guest memory, fail if any page isn't accessible
+		static bool read_bytes(u32 addr, u32 size, char* dst);
+		static bool write_bytes(u32 addr, u32 size, const char* src);
+
+		// Block until the next vblank, or about a frame if RSX isn't running
+		static void wait_vblank();
+
 		template<typename... Args>
 		static void error(const const_str& fmt, const Args&&... args)
 		{
@@ -21,6 +21,9 @@ enum class thread_state : u32;
 namespace id_manager
 {
 	// Common global mutex
+	// Modifications of any ID map hold it exclusively together with the map's own mutex (always in this order)
+	// Plain lookups (idm::get/check without a function) only take the map's mutex, so unrelated types don't contend
+	// Code which needs a consistent view of several types (*_unlocked functions, callbacks, select) holds it instead
 	extern shared_mutex g_mutex;
 
 	template <typename T>
@@ -246,7 +249,7 @@ namespace id_manager
 	struct id_map
 	{
 		std::vector<std::pair<id_key, std::shared_ptr<void>>> vec{}, private_copy{};
-		shared_mutex mutex{}; // TODO: Use this instead of global mutex
+		shared_mutex mutex{}; // Protects vec for plain lookups, see g_mutex
 
 		id_map()
 		{
@@ -496,6 +499,8 @@ class idm
 
 		auto& map = g_fxo->get<id_manager::id_map<T>>();
 
+		std::lock_guard map_lock(map.mutex);
+
 		if (auto* place = allocate_id(map.vec, get_type<Type>(), id, traits::base, traits::step, traits::count, traits::uses_lowest_id, traits::invl_range))
 		{
 			// Get object, store it
@@ -517,7 +522,16 @@ public:
 	static inline void clear()
 	{
 		std::lock_guard lock(id_manager::g_mutex);
-		g_fxo->get<id_manager::id_map<T>>().vec.clear();
+		auto& map = g_fxo->get<id_manager::id_map<T>>();
+		std::lock_guard map_lock(map.mutex);
+		map.vec.clear();
+	}
+
+	// Mutex of the ID map of a type, it must be held along with g_mutex to modify a record returned by find_unlocked()
+	template <typename T>
+	static inline shared_mutex& get_map_mutex()
+	{
+		return g_fxo->get<id_manager::id_map<T>>().mutex;
 	}
 
 	// Get last ID (updated in create_id/allocate_id)
@@ -599,7 +613,7 @@ public:
 	template <typename T, typename Get = T>
 	static inline Get* check(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_map_mutex<T>());
 
 		return check_unlocked<T, Get>(id);
 	}
@@ -653,7 +667,7 @@ public:
 	template <typename T, typename Get = T>
 	static inline std::shared_ptr<Get> get(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_map_mutex<T>());
 
 		return get_unlocked<T, Get>(id);
 	}
@@ -740,6 +754,7 @@ public:
 		std::shared_ptr<void> ptr;
 		{
 			std::lock_guard lock(id_manager::g_mutex);
+			std::lock_guard map_lock(get_map_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id))
 			{
@@ -761,6 +776,7 @@ public:
 		std::shared_ptr<void> ptr;
 		{
 			std::lock_guard lock(id_manager::g_mutex);
+			std::lock_guard map_lock(get_map_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id); found &&
 				(!found->second.owner_before(sptr) && !sptr.owner_before(found->second)))
@@ -783,6 +799,7 @@ public:
 		std::shared_ptr<Get> ptr;
 		{
 			std::lock_guard lock(id_manager::g_mutex);
+			std::lock_guard map_lock(get_map_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id))
 			{
@@ -805,6 +822,7 @@ public:
 		}
 
 		std::unique_lock lock(id_manager::g_mutex);
+		std::lock_guard map_lock(get_map_mutex<T>());
 
 		if (const auto found = find_index<T, Get>(index, id))
 		{
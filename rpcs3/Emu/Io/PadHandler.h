@@ -205,6 +205,8 @@ public:
 	virtual std::vector<pad_list_entry> list_devices() = 0;
 	// Callback called during pad_thread::ThreadFunc
 	virtual void process();
+	// Blocks until a bound device has new input or the timeout expires. Returns false if the handler can't wait on its devices.
+	virtual bool wait_for_input(u64 /*timeout_us*/) { return false; }
 	// Binds a Pad to a device
 	virtual bool bindPadToDevice(std::shared_ptr<Pad> pad, u8 player_id);
 	virtual void init_config(cfg_pad* cfg) = 0;
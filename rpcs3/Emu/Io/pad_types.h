@@ -1,6 +1,7 @@
 #pragma once
 
 #include "util/types.hpp"
+#include "util/atomic.hpp"
 #include "Emu/Io/pad_config_types.h"
 
 #include <vector>
@@ -321,6 +322,9 @@ struct Pad
 	bool ldd{false};
 	u8 ldd_data[132] = {};
 
+	// Host time (get_system_time) of the oldest input event not yet returned by cellPadGetData, 0 if unknown
+	atomic_t<u64> m_input_timestamp{0};
+
 	explicit Pad(pad_handler handler, u32 port_status, u32 device_capability, u32 device_type)
 		: m_pad_handler(handler)
 		, m_port_status(port_status)
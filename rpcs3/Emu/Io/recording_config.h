@@ -16,6 +16,7 @@ struct cfg_recording final : cfg::node
 	cfg::uint<0, 25000000> video_bps{this, "Video Bitrate", 4000000};
 	cfg::uint<0, 5> max_b_frames{this, "Max B-Frames", 2};
 	cfg::uint<0, 20> gop_size{this, "Group of Pictures Size", 12};
+	cfg::uint<0, 16> encoder_threads{this, "Encoder Threads", 0}; // 0 = auto
 
 	const std::string path;
 };
@@ -134,6 +134,7 @@ namespace rpcn
 	{
 		std::lock_guard lock(inst_mutex);
 		terminate = true;
+		abort_sync_replies();
 		sem_rpcn.release();
 		sem_reader.release();
 		sem_writer.release();
@@ -373,8 +374,25 @@ namespace rpcn
 				command == CommandType::SendMessage || command == CommandType::SendToken ||
 				command == CommandType::SendResetToken || command == CommandType::ResetPassword)
 			{
-				std::lock_guard lock(mutex_replies_sync);
-				replies_sync.insert(std::make_pair(packet_id, std::make_pair(command, std::move(data))));
+				std::shared_ptr<reply_completion> completion;
+				{
+					std::lock_guard lock(mutex_replies_sync);
+					if (auto r = replies_sync.find(packet_id); r != replies_sync.end())
+					{
+						completion = std::move(r->second);
+						replies_sync.erase(r);
+					}
+				}
+
+				if (!completion)
+				{
+					rpcn_log.error("Received a reply to an unknown request(command: %d, packet_id: 0x%x)", command, packet_id);
+					break;
+				}
+
+				completion->data = std::move(data);
+				completion->state = reply_completion::received;
+				completion->state.notify_one();
 			}
 			else
 			{
@@ -424,6 +442,7 @@ namespace rpcn
 
 			received_version     = reinterpret_cast<le_t<u32>&>(data[0]);
 			server_info_received = true;
+			server_info_received.notify_all();
 			break;
 		}
 
@@ -568,10 +587,22 @@ namespace rpcn
 
 	bool rpcn_client::forge_send_reply(u16 command, u64 packet_id, const std::vector<u8>& data, std::vector<u8>& reply_data)
 	{
-		if (!forge_send(command, packet_id, data))
+		// The completion is registered before sending so that the reader thread can't receive the reply first
+		const auto completion = std::make_shared<reply_completion>();
+		{
+			std::lock_guard lock(mutex_replies_sync);
+			replies_sync.insert_or_assign(packet_id, completion);
+		}
+
+		// A disconnection before the registration wouldn't have aborted it
+		if (!connected || terminate || !forge_send(command, packet_id, data))
+		{
+			std::lock_guard lock(mutex_replies_sync);
+			replies_sync.erase(packet_id);
 			return false;
+		}
 
-		if (!get_reply(packet_id, reply_data))
+		if (!get_reply(completion, reply_data))
 			return false;
 
 		return true;
@@ -614,6 +645,8 @@ namespace rpcn
 		connected            = false;
 		authentified         = false;
 		server_info_received = false;
+
+		abort_sync_replies();
 	}
 
 	bool rpcn_client::connect(const std::string& host)
@@ -771,7 +804,8 @@ namespace rpcn
 
 		while (!server_info_received && connected && !terminate)
 		{
-			std::this_thread::sleep_for(5ms);
+			// Woken up by the reader thread, the timeout covers a disconnection between the check and the wait
+			server_info_received.wait(false, atomic_wait_timeout{100'000'000});
 		}
 
 		if (!connected || terminate)
@@ -1123,32 +1157,36 @@ namespace rpcn
 		return ret_new_messages;
 	}
 
-	bool rpcn_client::get_reply(const u64 expected_id, std::vector<u8>& data)
+	bool rpcn_client::get_reply(const std::shared_ptr<reply_completion>& completion, std::vector<u8>& data)
 	{
-		auto check_for_reply = [this, expected_id, &data]() -> bool
+		while (completion->state == reply_completion::pending)
 		{
-			std::lock_guard lock(mutex_replies_sync);
-			if (auto r = replies_sync.find(expected_id); r != replies_sync.end())
-			{
-				data = std::move(r->second.second);
-				replies_sync.erase(r);
-				return true;
-			}
+			completion->state.wait(reply_completion::pending);
+		}
+
+		if (completion->state != reply_completion::received)
 			return false;
-		};
 
-		while (connected && !terminate)
+		data = std::move(completion->data);
+		return true;
+	}
+
+	// Fails all synchronous requests waiting for a reply and wakes up connect
+	void rpcn_client::abort_sync_replies()
+	{
 		{
-			if (check_for_reply())
-				return true;
+			std::lock_guard lock(mutex_replies_sync);
 
-			std::this_thread::sleep_for(5ms);
-		}
+			for (auto& [id, completion] : replies_sync)
+			{
+				completion->state = reply_completion::aborted;
+				completion->state.notify_one();
+			}
 
-		if (check_for_reply())
-			return true;
+			replies_sync.clear();
+		}
 
-		return false;
+		server_info_received.notify_all();
 	}
 
 	bool rpcn_client::get_server_list(u32 req_id, const SceNpCommunicationId& communication_id, std::vector<u16>& server_list)
@@ -1873,6 +1911,7 @@ namespace rpcn
 	bool rpcn_client::error_and_disconnect(const std::string& error_msg)
 	{
 		connected = false;
+		abort_sync_replies();
 		rpcn_log.error("%s", error_msg);
 		return false;
 	}
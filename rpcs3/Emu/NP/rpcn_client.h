@@ -431,7 +431,22 @@ namespace rpcn
 		}
 
 	private:
-		bool get_reply(u64 expected_id, std::vector<u8>& data);
+		// Completion of a synchronous request, signalled by the reader thread
+		struct reply_completion
+		{
+			enum : u32
+			{
+				pending,
+				received,
+				aborted,
+			};
+
+			atomic_t<u32> state = pending;
+			std::vector<u8> data;
+		};
+
+		bool get_reply(const std::shared_ptr<reply_completion>& completion, std::vector<u8>& data);
+		void abort_sync_replies();
 
 		std::vector<u8> forge_request(u16 command, u64 packet_id, const std::vector<u8>& data) const;
 		bool forge_send(u16 command, u64 packet_id, const std::vector<u8>& data);
@@ -461,7 +476,7 @@ namespace rpcn
 		shared_mutex mutex_notifs, mutex_replies, mutex_replies_sync;
 		std::vector<std::pair<u16, std::vector<u8>>> notifications;            // notif type / data
 		std::unordered_map<u32, std::pair<u16, std::vector<u8>>> replies;      // req id / (command / data)
-		std::unordered_map<u64, std::pair<u16, std::vector<u8>>> replies_sync; // same but for sync replies(Login, Create, GetServerList)
+		std::unordered_map<u64, std::shared_ptr<reply_completion>> replies_sync; // req id / completion for sync replies(Login, Create, GetServerList)
 
 		// Messages
 		struct message_cb_t
@@ -22,6 +22,13 @@ protected:
 	{
 		usz alloc_size = utils::align(size, Alignment);
 		usz aligned_put_pos = utils::align(m_put_pos, Alignment);
+
+		if (m_pinned_pos != umax && m_allocated_pos + get_consumed_size(aligned_put_pos, alloc_size) > m_pinned_pos + m_size)
+		{
+			// Would overwrite pinned data
+			return false;
+		}
+
 		if (aligned_put_pos + alloc_size < m_size)
 		{
 			// range before get
@@ -45,6 +52,17 @@ protected:
 		}
 	}
 
+	// Bytes an allocation moves the put position by, including alignment and the skipped end of the heap on wrap-around
+	usz get_consumed_size(usz aligned_put_pos, usz alloc_size) const
+	{
+		if (aligned_put_pos + alloc_size < m_size)
+		{
+			return aligned_put_pos + alloc_size - m_put_pos;
+		}
+
+		return m_size - m_put_pos + alloc_size;
+	}
+
 	// Grow the buffer to hold at least size bytes
 	virtual bool grow(usz /*size*/)
 	{
@@ -58,6 +76,12 @@ protected:
 	usz m_current_allocated_size;
 	usz m_largest_allocated_pool;
 
+	// Total bytes consumed since creation, the offset of a position is always (position % m_size)
+	u64 m_allocated_pos = 0;
+
+	// Oldest position which must not be overwritten yet, for data kept beyond the frame it was allocated in
+	u64 m_pinned_pos = umax;
+
 	char* m_name;
 public:
 	data_heap() = default;
@@ -75,6 +99,10 @@ public:
 		m_put_pos = 0;
 		m_get_pos = heap_size - 1;
 
+		// Restart at offset 0, a whole heap length ahead so nothing allocated before looks alive
+		m_allocated_pos = utils::align(m_allocated_pos, heap_size) + heap_size;
+		m_pinned_pos = umax;
+
 		//allocation stats
 		m_min_guard_size = min_guard_size;
 		m_current_allocated_size = 0;
@@ -93,6 +121,8 @@ public:
 					m_name, m_size, m_current_allocated_size, size, m_min_guard_size, m_largest_allocated_pool);
 		}
 
+		m_allocated_pos += get_consumed_size(aligned_put_pos, alloc_size);
+
 		const usz block_length = (aligned_put_pos - m_put_pos) + alloc_size;
 		m_current_allocated_size += block_length;
 		m_largest_allocated_pool = std::max(m_largest_allocated_pool, block_length);
@@ -120,9 +150,29 @@ public:
 	virtual bool is_critical() const
 	{
 		const usz guard_length = std::max(m_min_guard_size, m_largest_allocated_pool);
+
+		if (m_pinned_pos != umax && (m_allocated_pos + guard_length) >= (m_pinned_pos + m_size))
+		{
+			return true;
+		}
+
 		return (m_current_allocated_size + guard_length) >= m_size;
 	}
 
+	/**
+	* Position after the last allocation, see m_allocated_pos
+	*/
+	u64 get_allocated_pos() const
+	{
+		return m_allocated_pos;
+	}
+
+	// Keep the heap from overwriting data from the given position on (umax to unpin)
+	void pin(u64 pos)
+	{
+		m_pinned_pos = pos;
+	}
+
 	void reset_allocation_stats()
 	{
 		m_current_allocated_size = 0;
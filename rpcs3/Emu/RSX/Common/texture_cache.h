@@ -482,6 +482,21 @@ namespace rsx
 			return true;
 		}
 
+		// Checks whether any locked section inside the range holds GPU data that would need to be written back
+		// Must be called with the cache lock held
+		bool region_has_flushables(const address_range &test_range)
+		{
+			for (auto It = m_storage.range_begin(test_range, locked_range, true); It != m_storage.range_end(); It++)
+			{
+				if ((*It).is_flushable())
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
 		/**
 		 * Section invalidation
 		 */
@@ -714,8 +729,12 @@ namespace rsx
 			AUDIT(!ranges_to_protect_ro.overlaps(ranges_to_unprotect));
 
 			// Unprotect and discard
-			protect_ranges(ranges_to_unprotect, utils::protection::rw);
-			protect_ranges(ranges_to_protect_ro, utils::protection::ro);
+			{
+				rsx::write_tracking::batch protect_batch;
+				protect_ranges(ranges_to_unprotect, utils::protection::rw);
+				protect_ranges(ranges_to_protect_ro, utils::protection::ro);
+			}
+
 			discard_set(data.sections_to_unprotect);
 			discard_set(data.sections_to_flush);
 
@@ -1397,11 +1416,29 @@ namespace rsx
 		thrashed_set invalidate_address(commandbuffer_type& cmd, u32 address, invalidation_cause cause, Args&&... extras)
 		{
 			//Test before trying to acquire the lock
-			const auto range = page_for(address);
+			auto range = page_for(address);
 			if (!region_intersects_cache(range, !cause.is_read()))
 				return{};
 
 			std::lock_guard lock(m_cache_mutex);
+			rsx::write_tracking::batch protect_batch;
+
+			if (cause.is_read())
+			{
+				rsx::write_tracking::on_fault();
+			}
+			else if (rsx::write_tracking::on_write_fault(address))
+			{
+				// CPU is streaming through neighbouring pages, release the whole block now instead of taking a fault per page
+				const auto neighbourhood = rsx::write_tracking::get_neighbourhood(address);
+
+				if (!region_has_flushables(neighbourhood))
+				{
+					rsx::write_tracking::on_neighbourhood_release();
+					range = neighbourhood;
+				}
+			}
+
 			return invalidate_range_impl_base(cmd, range, cause, std::forward<Args>(extras)...);
 		}
 
@@ -3007,7 +3044,7 @@ namespace rsx
 					{
 						// Keep Cell from touching the range we need
 						const auto prot_range = dst_range.to_page_range();
-						utils::memory_protect(vm::base(prot_range.start), prot_range.length(), utils::protection::no);
+						rsx::write_tracking::protect(prot_range, utils::protection::no);
 
 						force_dma_load = true;
 					}
@@ -3038,7 +3075,7 @@ namespace rsx
 						// HACK: workaround for data race with Cell
 						// Pre-lock the memory range we'll be touching, then load with super_ptr
 						const auto prot_range = dst_range.to_page_range();
-						utils::memory_protect(vm::base(prot_range.start), prot_range.length(), utils::protection::no);
+						rsx::write_tracking::protect(prot_range, utils::protection::no);
 
 						const auto pitch_in_block = dst.pitch / dst_bpp;
 						std::vector<rsx::subresource_layout> subresource_layout;
@@ -3206,6 +3243,7 @@ namespace rsx
 				if (m_cache_update_tag.load() != m_flush_always_update_timestamp)
 				{
 					std::lock_guard lock(m_cache_mutex);
+					rsx::write_tracking::batch protect_batch;
 					bool update_tag = false;
 
 					for (const auto &It : m_flush_always_cache)
@@ -3283,6 +3321,8 @@ namespace rsx
 			m_unavoidable_hard_faults_this_frame.store(0u);
 			m_texture_upload_calls_this_frame.store(0u);
 			m_texture_upload_misses_this_frame.store(0u);
+
+			rsx::write_tracking::on_frame_end();
 		}
 
 		void on_flush()
@@ -3,6 +3,7 @@
 #include "texture_cache_types.h"
 #include "texture_cache_predictor.h"
 #include "TextureUtils.h"
+#include "write_tracking.h"
 
 #include "Emu/Memory/vm.h"
 #include "util/vm.hpp"
@@ -30,7 +31,7 @@ namespace rsx
 		ensure(range.is_page_range());
 
 		//rsx_log.error("memory_protect(0x%x, 0x%x, %x)", static_cast<u32>(range.start), static_cast<u32>(range.length()), static_cast<u32>(prot));
-		utils::memory_protect(vm::base(range.start), range.length(), prot);
+		rsx::write_tracking::protect(range, prot);
 
 #ifdef TEXTURE_CACHE_DEBUG
 		tex_cache_checker.set_protection(range, prot);
@@ -308,6 +309,8 @@ namespace rsx
 
 		inline void clear()
 		{
+			rsx::write_tracking::batch protect_batch;
+
 			for (auto &section : *this)
 			{
 				if (section.is_locked())
@@ -0,0 +1,313 @@
+#include "stdafx.h"
+#include "write_tracking.h"
+
+#include "Emu/Memory/vm.h"
+#include "Utilities/mutex.h"
+
+namespace rsx
+{
+	namespace write_tracking
+	{
+		struct protect_request
+		{
+			u32 start;
+			u32 end;
+			utils::protection prot;
+		};
+
+		struct counters
+		{
+			atomic_t<u32> protect_requests = 0;
+			atomic_t<u32> protect_calls = 0;
+			atomic_t<u32> faults = 0;
+			atomic_t<u32> neighbourhood_faults = 0;
+		};
+
+		// Pending requests of the active batch on this thread
+		thread_local batch* g_tls_active_batch = nullptr;
+		thread_local std::vector<protect_request> g_tls_pending;
+
+		counters g_counters;
+		write_tracking_stats g_last_frame_stats;
+		shared_mutex g_stats_mutex;
+
+		// One bit per 4k guest page, set while the page is protected through this module
+		std::array<atomic_t<u64>, 0x1'0000'0000ull / 4096 / 64> g_protected_pages{};
+
+		// Small history of recently faulting blocks used to detect streaming writes
+		std::array<atomic_t<u32>, 8> g_recent_fault_blocks{};
+		atomic_t<u32> g_recent_fault_index = 0;
+
+		static void update_protected_pages(u32 start, u32 end, bool set)
+		{
+			const u32 first = start / 4096;
+			const u32 last = end / 4096;
+
+			for (u32 word = first / 64; word <= last / 64; word++)
+			{
+				const u32 lo = std::max(first, word * 64) % 64;
+				const u32 hi = std::min(last, word * 64 + 63) % 64;
+				const u64 mask = (hi == 63 ? u64{umax} : ((u64{1} << (hi + 1)) - 1)) & ~((u64{1} << lo) - 1);
+
+				if (set)
+				{
+					g_protected_pages[word] |= mask;
+				}
+				else
+				{
+					g_protected_pages[word] &= ~mask;
+				}
+			}
+		}
+
+		static void apply(u32 start, u32 end, utils::protection prot)
+		{
+			// Publish locks before they take effect and unlocks after, so that is_range_unprotected stays conservative
+			if (prot != utils::protection::rw)
+			{
+				update_protected_pages(start, end, true);
+			}
+
+			utils::memory_protect(vm::base(start), (end - start) + 1, prot);
+			g_counters.protect_calls++;
+
+			if (prot == utils::protection::rw)
+			{
+				update_protected_pages(start, end, false);
+			}
+		}
+
+		static void flush(std::vector<protect_request>& requests)
+		{
+			if (requests.size() == 1)
+			{
+				apply(requests[0].start, requests[0].end, requests[0].prot);
+				requests.clear();
+				return;
+			}
+
+			std::vector<protect_request> runs;
+			runs.reserve(requests.size());
+
+			std::vector<u32> order(requests.size());
+			for (u32 i = 0; i < order.size(); ++i)
+			{
+				order[i] = i;
+			}
+
+			std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b)
+			{
+				return requests[a].start < requests[b].start;
+			});
+
+			bool overlapping = false;
+			for (usz i = 1; i < order.size(); ++i)
+			{
+				if (requests[order[i]].start <= requests[order[i - 1]].end)
+				{
+					overlapping = true;
+					break;
+				}
+			}
+
+			if (!overlapping)
+			{
+				// Fast path, request order does not matter
+				for (u32 index : order)
+				{
+					runs.push_back(requests[index]);
+				}
+			}
+			else
+			{
+				// Split into elementary intervals, the latest request covering each one wins
+				std::vector<u64> bounds;
+				bounds.reserve(requests.size() * 2);
+
+				for (const auto& req : requests)
+				{
+					bounds.push_back(req.start);
+					bounds.push_back(u64{req.end} + 1);
+				}
+
+				std::sort(bounds.begin(), bounds.end());
+				bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+				for (usz i = 0; i + 1 < bounds.size(); ++i)
+				{
+					const u32 start = static_cast<u32>(bounds[i]);
+					const u32 end = static_cast<u32>(bounds[i + 1] - 1);
+
+					for (auto it = requests.rbegin(); it != requests.rend(); ++it)
+					{
+						if (it->start <= start && it->end >= end)
+						{
+							runs.push_back({ start, end, it->prot });
+							break;
+						}
+					}
+				}
+			}
+
+			// Merge contiguous runs with identical protection
+			usz out = 0;
+			for (usz i = 1; i < runs.size(); ++i)
+			{
+				auto& last = runs[out];
+
+				if (runs[i].prot == last.prot && u64{last.end} + 1 == runs[i].start)
+				{
+					last.end = runs[i].end;
+					continue;
+				}
+
+				runs[++out] = runs[i];
+			}
+
+			runs.resize(out + 1);
+
+			for (const auto& run : runs)
+			{
+				apply(run.start, run.end, run.prot);
+			}
+
+			requests.clear();
+		}
+
+		batch::batch()
+		{
+			m_parent = g_tls_active_batch;
+
+			if (!m_parent)
+			{
+				g_tls_active_batch = this;
+			}
+		}
+
+		batch::~batch()
+		{
+			if (m_parent)
+			{
+				return;
+			}
+
+			g_tls_active_batch = nullptr;
+
+			if (!g_tls_pending.empty())
+			{
+				flush(g_tls_pending);
+			}
+		}
+
+		void protect(const utils::address_range& range, utils::protection prot)
+		{
+			ensure(range.is_page_range());
+			g_counters.protect_requests++;
+
+			if (!g_tls_active_batch)
+			{
+				apply(range.start, range.end, prot);
+				return;
+			}
+
+			g_tls_pending.push_back({ range.start, range.end, prot });
+		}
+
+		bool is_range_unprotected(u32 addr, u32 size)
+		{
+			if (!size)
+			{
+				return true;
+			}
+
+			const u32 first = addr / 4096;
+			const u32 last = static_cast<u32>((u64{addr} + size - 1) / 4096);
+
+			for (u32 page = first; page <= last; page++)
+			{
+				if (page % 64 == 0 && page + 63 <= last)
+				{
+					// Whole word test
+					if (g_protected_pages[page / 64])
+					{
+						return false;
+					}
+
+					page += 63;
+					continue;
+				}
+
+				if (g_protected_pages[page / 64] & (u64{1} << (page % 64)))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool on_write_fault(u32 address)
+		{
+			g_counters.faults++;
+
+			const u32 block = address / neighbourhood_size;
+			bool streaming = false;
+
+			for (const auto& recent : g_recent_fault_blocks)
+			{
+				// Blocks are stored off by one so that zero stays an empty slot
+				if (const u32 value = recent.load())
+				{
+					const u32 recent_block = value - 1;
+
+					if (recent_block + 1 >= block && recent_block <= block + 1)
+					{
+						streaming = true;
+						break;
+					}
+				}
+			}
+
+			g_recent_fault_blocks[g_recent_fault_index++ % g_recent_fault_blocks.size()] = block + 1;
+			return streaming;
+		}
+
+		void on_fault()
+		{
+			g_counters.faults++;
+		}
+
+		void on_neighbourhood_release()
+		{
+			g_counters.neighbourhood_faults++;
+		}
+
+		utils::address_range get_neighbourhood(u32 address)
+		{
+			return utils::address_range::start_length(address & ~(neighbourhood_size - 1), neighbourhood_size);
+		}
+
+		void on_frame_end()
+		{
+			write_tracking_stats stats;
+			stats.protect_requests = g_counters.protect_requests.exchange(0);
+			stats.protect_calls = g_counters.protect_calls.exchange(0);
+			stats.faults = g_counters.faults.exchange(0);
+			stats.neighbourhood_faults = g_counters.neighbourhood_faults.exchange(0);
+
+			for (auto& recent : g_recent_fault_blocks)
+			{
+				recent.release(0);
+			}
+
+			std::lock_guard lock(g_stats_mutex);
+			g_last_frame_stats = stats;
+		}
+
+		write_tracking_stats get_frame_stats()
+		{
+			reader_lock lock(g_stats_mutex);
+			return g_last_frame_stats;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Utilities/address_range.h"
+#include "util/vm.hpp"
+
+namespace rsx
+{
+	struct write_tracking_stats
+	{
+		u32 protect_requests = 0;          // Protection changes requested by the caches
+		u32 protect_calls = 0;             // Protection changes actually issued to the host after coalescing
+		u32 faults = 0;                    // Access violations resolved by the RSX caches
+		u32 neighbourhood_faults = 0;      // Faults that were resolved by releasing the whole surrounding block
+	};
+
+	namespace write_tracking
+	{
+		// Size of the block released at once when CPU writes stream through protected memory
+		constexpr u32 neighbourhood_size = 0x10000;
+
+		/**
+		 * Scoped batch of page protection changes.
+		 * While alive, all protection requests made on the owning thread are queued and applied on destruction,
+		 * with adjacent ranges sharing the same protection merged into a single host call.
+		 * Batches can be nested, only the outermost one flushes.
+		 */
+		class batch
+		{
+			batch* m_parent = nullptr;
+
+		public:
+			batch();
+			~batch();
+
+			batch(const batch&) = delete;
+			batch& operator=(const batch&) = delete;
+		};
+
+		// Change protection of a page-aligned range of guest memory, deferred if a batch is active
+		void protect(const utils::address_range& range, utils::protection prot);
+
+		// Returns true if no page overlapping the range is currently protected by the RSX caches.
+		// This is a snapshot, the caller must tolerate the range getting locked right after the test.
+		bool is_range_unprotected(u32 addr, u32 size);
+
+		// Record a write fault. Returns true if neighbouring pages faulted recently and the block should be released in one pass.
+		bool on_write_fault(u32 address);
+
+		// Record a fault handled outside of the texture cache (e.g. ZCULL report pages)
+		void on_fault();
+
+		// Account for a fault that was resolved by releasing its whole neighbourhood
+		void on_neighbourhood_release();
+
+		// Returns the block surrounding the address
+		utils::address_range get_neighbourhood(u32 address);
+
+		// Latch the per-frame counters
+		void on_frame_end();
+
+		// Counters of the last completed frame
+		write_tracking_stats get_frame_stats();
+	}
+}
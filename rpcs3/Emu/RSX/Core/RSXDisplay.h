@@ -11,6 +11,9 @@ namespace rsx
 		u32 draw_calls;
 		u32 submit_count;
 
+		u32 vertex_cache_hits;
+		u32 vertex_cache_misses;
+
 		s64 setup_time;
 		s64 vertex_upload_time;
 		s64 textures_upload_time;
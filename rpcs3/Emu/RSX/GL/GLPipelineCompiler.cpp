@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "GLPipelineCompiler.h"
 #include "Utilities/Thread.h"
+#include "Utilities/job_system.h"
 
 #include <thread>
 
@@ -42,6 +43,9 @@ namespace gl
 		{
 			for (auto&& job : m_work_queue.pop_all())
 			{
+				// The context is bound to this thread, so only the budget slot is shared with the job system
+				utils::job_slot slot(utils::job_class::foreground);
+
 				if (!m_context_ready.test_and_set())
 				{
 					// Bind context on first use
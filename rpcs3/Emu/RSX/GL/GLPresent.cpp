@@ -238,7 +238,8 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 	{
 		if (g_user_asked_for_screenshot || (g_recording_mode != recording_mode::stopped && m_frame->can_consume_frame()))
 		{
-			std::vector<u8> sshot_frame(buffer_height * buffer_width * 4);
+			std::vector<u8>& sshot_frame = m_capture_frame;
+			sshot_frame.resize(buffer_height * buffer_width * 4);
 
 			gl::pixel_pack_settings pack_settings{};
 			pack_settings.apply();
@@ -367,6 +368,9 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 		println(fmt::format("Texture memory: %12dM", texture_memory_size));
 		println(fmt::format("Flush requests: %12d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate));
 		println(fmt::format("Texture uploads: %15u (%u from CPU - %02u%%)", num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio));
+
+		const auto write_tracking = rsx::write_tracking::get_frame_stats();
+		println(fmt::format("Write faults: %14u (%u block releases), %u protect calls for %u requests", write_tracking.faults, write_tracking.neighbourhood_faults, write_tracking.protect_calls, write_tracking.protect_requests));
 	}
 
 	if (gl::debug::g_vis_texture)
@@ -398,7 +402,7 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 
 	// Cleanup
 	m_gl_texture_cache.on_frame_end();
-	m_vertex_cache->purge();
+	m_vertex_cache->on_frame_end();
 
 	auto removed_textures = m_rtts.free_invalidated(cmd);
 	m_framebuffer_cache.remove_if([&](auto& fbo)
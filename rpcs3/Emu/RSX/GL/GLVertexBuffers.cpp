@@ -184,7 +184,6 @@ gl::vertex_upload_info GLGSRender::set_vertex_buffer()
 	{
 		//Check if cacheable
 		//Only data in the 'persistent' block may be cached
-		//TODO: make vertex cache keep local data beyond frame boundaries and hook notify command
 		bool in_cache = false;
 		bool to_store = false;
 		u32  storage_address = -1;
@@ -200,11 +199,13 @@ gl::vertex_upload_info GLGSRender::set_vertex_buffer()
 				ensure(cached->local_address == storage_address);
 
 				in_cache = true;
+				m_frame_stats.vertex_cache_hits++;
 				upload_info.persistent_mapping_offset = cached->offset_in_heap;
 			}
 			else
 			{
 				to_store = true;
+				m_frame_stats.vertex_cache_misses++;
 			}
 		}
 
@@ -22,6 +22,9 @@ protected:
 	GSFrameBase* m_frame;
 	draw_context_t m_context = nullptr;
 
+	// Frame captured for recordings, kept to receive the recycled buffers of the video sink
+	std::vector<u8> m_capture_frame;
+
 public:
 	~GSRender() override;
 
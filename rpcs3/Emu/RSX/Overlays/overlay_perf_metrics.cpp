@@ -238,7 +238,7 @@ namespace rsx
 			case detail_level::minimal: [[fallthrough]];
 			case detail_level::low: m_titles.set_text(""); break;
 			case detail_level::medium: m_titles.set_text(fmt::format("\n\n%s", title1_medium)); break;
-			case detail_level::high: m_titles.set_text(fmt::format("\n\n%s\n\n\n\n\n\n%s", title1_high, title2)); break;
+			case detail_level::high: m_titles.set_text(fmt::format("\n\n%s\n\n\n\n\n\n%s\n\n\n%s", title1_high, title2, title3)); break;
 			}
 			m_titles.auto_resize();
 			m_titles.refresh();
@@ -473,6 +473,7 @@ namespace rsx
 						m_frametime = std::max(0.f, static_cast<float>(elapsed_update / m_frames));
 
 						m_rsx_load = rsx_thread.get_load();
+						m_vertex_cache_hit_rate = rsx_thread.get_vertex_cache_hit_rate();
 
 						m_total_threads = utils::cpu_stats::get_current_thread_count();
 
@@ -566,8 +567,10 @@ namespace rsx
 					                         " RSX   : %04.1f %% ( 1)\n"
 					                         " Total : %04.1f %% (%2u)\n\n"
 					                         "%s\n"
-					                         " RSX   : %02u %%",
-					    m_fps, m_frametime, std::string(title1_high.size(), ' '), m_ppu_usage, m_ppus, m_spu_usage, m_spus, m_rsx_usage, m_cpu_usage, m_total_threads, std::string(title2.size(), ' '), m_rsx_load);
+					                         " RSX   : %02u %%\n\n"
+					                         "%s\n"
+					                         " Hits  : %02u %%",
+					    m_fps, m_frametime, std::string(title1_high.size(), ' '), m_ppu_usage, m_ppus, m_spu_usage, m_spus, m_rsx_usage, m_cpu_usage, m_total_threads, std::string(title2.size(), ' '), m_rsx_load, std::string(title3.size(), ' '), m_vertex_cache_hit_rate);
 					break;
 				}
 				}
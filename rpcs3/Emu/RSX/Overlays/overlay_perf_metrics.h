@@ -58,6 +58,7 @@ namespace rsx
 			const std::string title1_medium{ "CPU Utilization:" };
 			const std::string title1_high{ "Host Utilization (CPU):" };
 			const std::string title2{ "Guest Utilization (PS3):" };
+			const std::string title3{ "Vertex Cache:" };
 
 			f32 m_fps{0};
 			f32 m_frametime{0};
@@ -77,6 +78,7 @@ namespace rsx
 			f32 m_spu_usage{0};
 			f32 m_rsx_usage{0};
 			u32 m_rsx_load{0};
+			u32 m_vertex_cache_hit_rate{0};
 
 			void reset_transform(label& elm) const;
 			void reset_transforms();
@@ -7,6 +7,7 @@
 #include "Core/RSXReservationLock.hpp"
 #include "Emu/Memory/vm_reservation.h"
 #include "Emu/Cell/lv2/sys_rsx.h"
+#include "Utilities/Thread.h"
 #include "util/asm.hpp"
 
 #include <bitset>
@@ -20,13 +21,303 @@ namespace rsx
 {
 	namespace FIFO
 	{
+		// Reads method packets ahead of the RSX thread on a separate thread
+		// Only linear runs of method packets are decoded. Flow control, malformed commands and unreadable memory are left to
+		// the RSX thread, which restarts the decoder at the next packet header it fetches.
+		// Each ring entry stands for one word of the command buffer: a header entry holding the translated address of the
+		// first argument and the command, then one method/argument pair per argument.
+		// Packets which synchronize with other processors or write memory end the run until the RSX thread has executed them,
+		// the commands after them may not be written yet or may be overwritten by them.
+		class decoder
+		{
+			static constexpr u32 ring_size = 0x4000;
+
+			static constexpr std::array<bool, 0x10000 / 4> m_barriers = []
+			{
+				std::array<bool, 0x10000 / 4> barriers{};
+
+				for (u32 reg : { NV406E_SET_REFERENCE, NV406E_SEMAPHORE_ACQUIRE, NV406E_SEMAPHORE_RELEASE, NV4097_GET_REPORT,
+					NV4097_BACK_END_WRITE_SEMAPHORE_RELEASE, NV4097_TEXTURE_READ_SEMAPHORE_RELEASE, NV0039_BUFFER_NOTIFY, NV3089_IMAGE_IN })
+				{
+					barriers[reg] = true;
+				}
+
+				// Inline image transfers
+				for (u32 i = 0; i < 0x700; i++)
+				{
+					barriers[NV308A_COLOR + i] = true;
+				}
+
+				// Driver commands (flips, user interrupts)
+				for (u32 reg = GCM_SET_DRIVER_OBJECT; reg < barriers.size(); reg++)
+				{
+					barriers[reg] = true;
+				}
+
+				return barriers;
+			}();
+
+			const RsxDmaControl* const m_ctrl;
+			const rsx_iomap_table* const m_iotable;
+			const std::unique_ptr<register_pair[]> m_ring = std::make_unique<register_pair[]>(ring_size);
+
+			// Written by the RSX thread: session number (high) and index of the packet being executed (low)
+			// Changes on restarts and on each fetched packet header, the decoder sleeps on it when it can't make progress
+			atomic_t<u64> m_request = 0;
+
+			// Written by the RSX thread before starting a session: address of its first entry
+			atomic_t<u32> m_request_addr = 0;
+
+			// Written by the decoder: session number (high) and count of decoded entries (low)
+			atomic_t<u64> m_decoded = 0;
+
+			// Set by the decoder while it sleeps on m_request
+			atomic_t<u32> m_waiting = 0;
+
+			// RSX thread state
+			u32 m_session = 0;
+			u32 m_base = 0;
+			u32 m_pop = 0;
+
+			std::unique_ptr<named_thread<std::function<void()>>> m_thread;
+
+			// Decode the packet at pos, return the count of entries written, 0 to try again later or umax if it must be left to the RSX thread
+			u32 decode_packet(u32 pos, u32 put, u32 push, u32 pop, bool& barrier)
+			{
+				const u32 ea = m_iotable->get_addr(pos);
+
+				if (ea == umax || !vm::check_addr(ea))
+				{
+					return umax;
+				}
+
+				const u32 cmd = vm::read32(ea);
+
+				if (cmd & RSX_METHOD_NON_METHOD_CMD_MASK)
+				{
+					return umax;
+				}
+
+				const u32 count = (cmd >> 18) & 0x7ff;
+				const u32 inc = ((cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD) ? 0 : 4;
+
+				if (count + 1 > ring_size)
+				{
+					return umax;
+				}
+
+				// The whole packet must be committed and fit in the free part of the ring
+				if ((put - pos) / 4 < count + 1 || push + count + 1 - pop > ring_size)
+				{
+					return 0;
+				}
+
+				u32 args_ea = umax;
+				u32 arg_ea = 0;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					const u32 arg_pos = pos + (i + 1) * 4;
+
+					if (i == 0 || (arg_pos & 0xfffff) == 0)
+					{
+						// Translate again on each 1MB page of the IO address space
+						arg_ea = m_iotable->get_addr(arg_pos);
+
+						if (arg_ea == umax || !vm::check_addr(arg_ea, vm::page_readable, std::min<u32>((count - i) * 4, 0x100000 - (arg_pos & 0xfffff))))
+						{
+							return umax;
+						}
+
+						if (i == 0)
+						{
+							args_ea = arg_ea;
+						}
+					}
+
+					const u32 reg = (cmd & 0xfffc) + inc * i;
+
+					m_ring[(push + i + 1) % ring_size].set(reg, vm::read32(arg_ea));
+					arg_ea += 4;
+
+					barrier |= m_barriers[reg >> 2];
+				}
+
+				m_ring[push % ring_size].set(args_ea, cmd);
+				return count + 1;
+			}
+
+			void run()
+			{
+				u32 session = 0;
+				u32 base = 0;
+				u32 push = 0;
+				u32 barrier_index = umax;
+				bool stopped = true;
+
+				while (thread_ctrl::state() != thread_state::aborting)
+				{
+					const u64 request = m_request;
+
+					if (static_cast<u32>(request >> 32) != session)
+					{
+						session = static_cast<u32>(request >> 32);
+						base = m_request_addr;
+						push = 0;
+						barrier_index = umax;
+						stopped = false;
+						m_decoded.release(u64{session} << 32);
+					}
+
+					const u32 pop = static_cast<u32>(request);
+
+					// Sleep until the RSX thread fetches another packet header or restarts the decoder
+					const auto wait = [&]()
+					{
+						m_waiting = 1;
+						thread_ctrl::wait_on(m_request, request);
+						m_waiting = 0;
+					};
+
+					if (stopped || (barrier_index != umax && pop <= barrier_index))
+					{
+						wait();
+						continue;
+					}
+
+					barrier_index = umax;
+
+					const u32 pos = base + push * 4;
+					const u32 put = m_ctrl->put & ~3;
+
+					if (put == pos)
+					{
+						// Nothing committed ahead, the RSX thread will be woken up by PUT first
+						wait();
+						continue;
+					}
+
+					bool barrier = false;
+					const u32 written = decode_packet(pos, put, push, pop, barrier);
+
+					if (written == umax)
+					{
+						stopped = true;
+						continue;
+					}
+
+					if (!written)
+					{
+						// Ring full or packet partially committed
+						wait();
+						continue;
+					}
+
+					push += written;
+					m_decoded.release((u64{session} << 32) | push);
+
+					if (barrier)
+					{
+						barrier_index = push - 1;
+					}
+				}
+			}
+
+			void set_request(u32 index)
+			{
+				m_request = (u64{m_session} << 32) | index;
+
+				if (m_waiting)
+				{
+					m_request.notify_one();
+				}
+			}
+
+		public:
+			decoder(const RsxDmaControl* ctrl, const rsx_iomap_table* iotable)
+				: m_ctrl(ctrl)
+				, m_iotable(iotable)
+			{
+				m_thread = std::make_unique<named_thread<std::function<void()>>>("RSX Decoder"sv, [this]()
+				{
+					run();
+				});
+			}
+
+			~decoder()
+			{
+				m_thread.reset();
+			}
+
+			// Get the decoded packet header at addr (RSX thread only), args_ea receives the address of its first argument
+			// Packets before it are considered executed. Returns nullptr if the packet must be read from memory.
+			const register_pair* get_header(u32 addr, u32& args_ea)
+			{
+				const u64 decoded = m_decoded;
+				const u32 index = (addr - m_base) / 4;
+				const u32 available = (decoded >> 32) == m_session ? static_cast<u32>(decoded) : 0;
+
+				if (!m_session || addr - m_base >= 0x8000'0000 || index < m_pop || index > available)
+				{
+					// Reading position moved somewhere else (jump, call, recovery, skipped commands)
+					if (!m_session || (decoded >> 32) == m_session)
+					{
+						m_session++;
+						m_base = addr;
+						m_pop = 0;
+						m_request_addr = addr;
+						set_request(0);
+					}
+
+					return nullptr;
+				}
+
+				if (index != m_pop)
+				{
+					m_pop = index;
+					set_request(index);
+				}
+
+				if (index == available)
+				{
+					// Decoder is behind or waiting for the RSX thread to execute a barrier
+					return nullptr;
+				}
+
+				const register_pair& entry = m_ring[index % ring_size];
+				args_ea = entry.reg;
+				return &entry;
+			}
+
+			// Get the decoded argument at addr (RSX thread only), returns nullptr if it must be read from memory
+			const register_pair* get_arg(u32 addr) const
+			{
+				const u64 decoded = m_decoded;
+				const u32 index = (addr - m_base) / 4;
+
+				if (!m_session || (decoded >> 32) != m_session || addr - m_base >= 0x8000'0000 || index <= m_pop || index >= static_cast<u32>(decoded))
+				{
+					return nullptr;
+				}
+
+				return &m_ring[index % ring_size];
+			}
+		};
+
 		FIFO_control::FIFO_control(::rsx::thread* pctrl)
 		{
 			m_thread = pctrl;
 			m_ctrl = pctrl->ctrl;
 			m_iotable = &pctrl->iomap_table;
+
+			if (g_cfg.core.rsx_fifo_decode_ahead && !g_cfg.core.rsx_fifo_accuracy)
+			{
+				m_decoder = std::make_unique<decoder>(m_ctrl, m_iotable);
+			}
 		}
 
+		FIFO_control::~FIFO_control() = default;
+
 		void FIFO_control::sync_get() const
 		{
 			m_ctrl->get.release(m_internal_get);
@@ -259,7 +550,9 @@ namespace rsx
 					}
 
 					m_args_ptr += 4;
-					arg = vm::read32(m_args_ptr);
+
+					const register_pair* entry = m_decoder ? m_decoder->get_arg(m_internal_get + 4) : nullptr;
+					arg = entry ? entry->value : static_cast<u32>(vm::read32(m_args_ptr));
 				}
 
 				m_internal_get += 4;
@@ -327,6 +620,9 @@ namespace rsx
 				m_memwatch_cmp = 0;
 			}
 
+			// Address of the arguments, if they were translated by the decoder
+			u32 decoded_args_ptr = umax;
+
 			if (!g_cfg.core.rsx_fifo_accuracy) [[ likely ]]
 			{
 				const u32 put = read_put();
@@ -338,7 +634,11 @@ namespace rsx
 					return;
 				}
 
-				if (const u32 addr = m_iotable->get_addr(m_internal_get); addr + 1)
+				if (const register_pair* entry = m_decoder ? m_decoder->get_header(m_internal_get, decoded_args_ptr) : nullptr)
+				{
+					m_cmd = entry->value;
+				}
+				else if (const u32 addr = m_iotable->get_addr(m_internal_get); addr + 1)
 				{
 					m_cmd = vm::read32(addr);
 				}
@@ -426,7 +726,7 @@ namespace rsx
 			inc_get(true); // Wait for data block to become available
 
 			// Validate the args ptr if the command attempts to read from it
-			m_args_ptr = m_iotable->get_addr(m_internal_get);
+			m_args_ptr = decoded_args_ptr != umax ? decoded_args_ptr : m_iotable->get_addr(m_internal_get);
 			if (m_args_ptr == umax) [[unlikely]]
 			{
 				// Optional recovery
@@ -434,7 +734,8 @@ namespace rsx
 				return;
 			}
 
-			data.set(m_cmd & 0xfffc, vm::read32(m_args_ptr));
+			const register_pair* entry = m_decoder ? m_decoder->get_arg(m_internal_get) : nullptr;
+			data.set(m_cmd & 0xfffc, entry ? entry->value : static_cast<u32>(vm::read32(m_args_ptr)));
 		}
 
 		void flattening_helper::reset(bool _enabled)
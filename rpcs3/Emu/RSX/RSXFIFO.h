@@ -3,6 +3,7 @@
 #include "util/types.hpp"
 #include "Emu/RSX/gcm_enums.h"
 
+#include <memory>
 #include <span>
 
 struct RsxDmaControl;
@@ -126,12 +127,15 @@ namespace rsx
 			inline flatten_op test(register_pair& command);
 		};
 
+		class decoder;
+
 		class FIFO_control
 		{
 		private:
 			mutable rsx::thread* m_thread;
 			RsxDmaControl* m_ctrl = nullptr;
 			const rsx::rsx_iomap_table* m_iotable;
+			std::unique_ptr<decoder> m_decoder;
 			u32 m_internal_get = 0;
 
 			u32 m_memwatch_addr = 0;
@@ -149,7 +153,7 @@ namespace rsx
 
 		public:
 			FIFO_control(rsx::thread* pctrl);
-			~FIFO_control() = default;
+			~FIFO_control();
 
 			std::pair<bool, u32> fetch_u32(u32 addr);
 			void invalidate_cache() { m_cache_size = 0; }
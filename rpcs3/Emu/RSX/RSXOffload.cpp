@@ -6,6 +6,7 @@
 #include "RSXOffload.h"
 #include "RSXThread.h"
 
+#include <chrono>
 #include <thread>
 #include "util/asm.hpp"
 
@@ -13,21 +14,139 @@ namespace rsx
 {
 	struct dma_manager::offload_thread
 	{
-		lf_queue<transport_packet> m_work_queue;
+		// Packets live in a fixed ring which is reused in order, so queueing work does not allocate
+		// Every slot holds a sequence number telling whether it is free for a given push position or ready to be processed
+		static constexpr u32 ring_size = 1024;
+
+		struct packet_slot
+		{
+			atomic_t<u64> seq = 0;
+			transport_packet packet{};
+		};
+
+		const dma_manager* m_manager;
+		const u32 m_index;
+
+		std::unique_ptr<packet_slot[]> m_ring;
 		atomic_t<u64> m_enqueued_count = 0;
 		atomic_t<u64> m_processed_count = 0;
+		atomic_t<bool> m_sleeping = false;
 		transport_packet* m_current_job = nullptr;
 
 		thread_base* current_thread_ = nullptr;
 
-		void operator ()()
+		offload_thread(const dma_manager* manager, u32 index)
+			: m_manager(manager)
+			, m_index(index)
+			, m_ring(std::make_unique<packet_slot[]>(ring_size))
+		{
+			for (u32 i = 0; i < ring_size; i++)
+			{
+				m_ring[i].seq = i;
+			}
+		}
+
+		// Returns false if the ring is full
+		template <typename... Args>
+		bool try_enqueue(Args&&... args)
+		{
+			u64 pos = m_enqueued_count;
+
+			while (true)
+			{
+				auto& slot = m_ring[pos % ring_size];
+				const u64 seq = slot.seq;
+
+				if (seq == pos)
+				{
+					if (m_enqueued_count.compare_exchange(pos, pos + 1))
+					{
+						slot.packet = transport_packet(std::forward<Args>(args)...);
+						slot.seq.release(pos + 1);
+
+						if (m_sleeping)
+						{
+							m_enqueued_count.notify_one();
+						}
+
+						return true;
+					}
+				}
+				else if (seq < pos)
+				{
+					// The slot still holds a packet from the previous round
+					return false;
+				}
+				else
+				{
+					pos = m_enqueued_count;
+				}
+			}
+		}
+
+		template <typename... Args>
+		void enqueue(Args&&... args)
+		{
+			while (!try_enqueue(std::forward<Args>(args)...))
+			{
+				if (m_processed_count == umax)
+				{
+					// Worker is gone
+					return;
+				}
+
+				std::this_thread::yield();
+			}
+		}
+
+		u64 pending() const
+		{
+			return m_enqueued_count - std::min(m_enqueued_count.load(), m_processed_count.load());
+		}
+
+		void execute(transport_packet& job)
 		{
-			if (!g_cfg.video.multithreaded_rsx)
+			switch (job.type)
+			{
+			case raw_copy:
+			{
+				const u32 vm_addr = vm::try_get_addr(job.src).first;
+				rsx::reservation_lock<true, 1> rsx_lock(vm_addr, job.length, g_cfg.video.strict_rendering_mode && vm_addr);
+				std::memcpy(job.dst, job.src, job.length);
+				break;
+			}
+			case vector_copy:
+			{
+				std::memcpy(job.dst, job.opt_storage.data(), job.length);
+				break;
+			}
+			case index_emulate:
+			{
+				write_index_array_for_non_indexed_non_native_primitive_to_buffer(static_cast<char*>(job.dst), static_cast<rsx::primitive_type>(job.aux_param0), job.length);
+				break;
+			}
+			case callback:
 			{
-				// Abort if disabled
-				return;
+				// The backend expects the data of all earlier copies to be written
+				for (u32 i = 1; i < m_manager->m_workers.size(); i++)
+				{
+					auto& worker = *m_manager->m_workers[i];
+
+					for (const u64 target = worker.m_enqueued_count; worker.m_processed_count < target;)
+					{
+						utils::pause();
+					}
+				}
+
+				rsx::get_current_renderer()->renderctl(job.aux_param0, job.src);
+				break;
+			}
+			default: fmt::throw_exception("Unreachable");
 			}
+		}
 
+		void operator ()()
+		{
 			current_thread_ = thread_ctrl::get_current();
 			ensure(current_thread_);
 
@@ -36,49 +155,52 @@ namespace rsx
 				thread_ctrl::set_thread_affinity_mask(thread_ctrl::get_affinity_mask(thread_class::rsx));
 			}
 
+			u32 idle_loops = 0;
+
 			while (thread_ctrl::state() != thread_state::aborting)
 			{
-				for (auto&& job : m_work_queue.pop_all())
-				{
-					m_current_job = &job;
+				const u64 pos = m_processed_count;
+				auto& slot = m_ring[pos % ring_size];
 
-					switch (job.type)
-					{
-					case raw_copy:
-					{
-						const u32 vm_addr = vm::try_get_addr(job.src).first;
-						rsx::reservation_lock<true, 1> rsx_lock(vm_addr, job.length, g_cfg.video.strict_rendering_mode && vm_addr);
-						std::memcpy(job.dst, job.src, job.length);
-						break;
-					}
-					case vector_copy:
+				if (slot.seq != pos + 1)
+				{
+					if (m_enqueued_count != pos)
 					{
-						std::memcpy(job.dst, job.opt_storage.data(), job.length);
-						break;
+						// Reserved, but not written yet
+						utils::pause();
+						continue;
 					}
-					case index_emulate:
+
+					m_processed_count.notify_all();
+
+					// The first worker keeps spinning for latency, the copy workers go to sleep after a while
+					if (m_index == 0 || ++idle_loops < 1000)
 					{
-						write_index_array_for_non_indexed_non_native_primitive_to_buffer(static_cast<char*>(job.dst), static_cast<rsx::primitive_type>(job.aux_param0), job.length);
-						break;
+						std::this_thread::yield();
+						continue;
 					}
-					case callback:
+
+					m_sleeping = true;
+
+					if (m_enqueued_count == pos)
 					{
-						rsx::get_current_renderer()->renderctl(job.aux_param0, job.src);
-						break;
-					}
-					default: fmt::throw_exception("Unreachable");
+						thread_ctrl::wait_on(m_enqueued_count, pos);
 					}
 
-					m_processed_count.release(m_processed_count + 1);
+					m_sleeping = false;
+					continue;
 				}
 
+				idle_loops = 0;
+
+				m_current_job = &slot.packet;
+				execute(slot.packet);
 				m_current_job = nullptr;
 
-				if (m_enqueued_count.load() == m_processed_count.load())
-				{
-					m_processed_count.notify_all();
-					std::this_thread::yield();
-				}
+				// Release the vector storage now instead of when the slot gets reused
+				slot.packet = {};
+				slot.seq.release(pos + ring_size);
+				m_processed_count.release(pos + 1);
 			}
 
 			m_processed_count = -1;
@@ -88,63 +210,167 @@ namespace rsx
 		static constexpr auto thread_name = "RSX Offloader"sv;
 	};
 
+	dma_manager::dma_manager() = default;
+
+	dma_manager::~dma_manager()
+	{
+		if (!m_workers.empty())
+		{
+			const auto stats = get_statistics();
+			rsx_log.notice("DMA offload stats: %u transfers done immediately, %u offloaded (%u KiB) to %u worker(s), threshold: %u bytes",
+				stats.immediate_transfers, stats.offloaded_transfers, stats.offloaded_bytes / 1024, stats.workers, stats.max_immediate_transfer_size);
+		}
+	}
+
 	// initialization
 	void dma_manager::init()
 	{
-		m_thread = std::make_shared<named_thread<offload_thread>>();
+		if (!g_cfg.video.multithreaded_rsx)
+		{
+			return;
+		}
+
+		u32 copy_workers = g_cfg.video.offload_copy_workers;
+
+		if (!copy_workers)
+		{
+			// Only worth it with plenty of host threads left over
+			const u32 threads = utils::get_thread_count();
+			copy_workers = threads >= 16 ? 2 : threads >= 8 ? 1 : 0;
+		}
+
+		m_workers.emplace_back(std::make_unique<named_thread<offload_thread>>(this, 0u));
+
+		for (u32 i = 1; i <= copy_workers; i++)
+		{
+			m_workers.emplace_back(std::make_unique<named_thread<offload_thread>>(fmt::format("RSX Offloader %u", i), this, i));
+		}
+
+		static const u32 s_calibrated_size = calibrate_immediate_transfer_size(*m_workers[0]);
+		max_immediate_transfer_size = s_calibrated_size;
 	}
 
-	// General transport
-	void dma_manager::copy(void *dst, std::vector<u8>& src, u32 length) const
+	u32 dma_manager::calibrate_immediate_transfer_size(offload_thread& worker)
 	{
-		if (length <= max_immediate_transfer_size || !g_cfg.video.multithreaded_rsx)
+		// Offloading a copy pays off once copying it costs more than a round trip through a worker
+		// Copies are taken from a buffer larger than the caches to resemble guest memory reads
+		constexpr u32 probe_count = 256;
+		constexpr u32 max_size = 0x10000;
+		constexpr u32 step = 512;
+
+		std::vector<u8> src(32 * 0x100000, 0xcd);
+		std::vector<u8> dst(max_size);
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (u32 i = 0; i < probe_count; i++)
 		{
-			std::memcpy(dst, src.data(), length);
+			worker.enqueue(dst.data(), dst.data(), 0u);
+
+			while (worker.m_processed_count < worker.m_enqueued_count)
+			{
+				utils::pause();
+			}
 		}
-		else
+
+		const double round_trip_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / probe_count;
+
+		u32 result = step;
+		usz src_offset = 0;
+
+		for (u32 size = step; size <= max_size; size += step)
+		{
+			constexpr u32 copy_count = 8;
+
+			const auto copy_start = std::chrono::steady_clock::now();
+
+			for (u32 i = 0; i < copy_count; i++)
+			{
+				src_offset = (src_offset + max_size + 4096) % (src.size() - max_size);
+				std::memcpy(dst.data(), src.data() + src_offset, size);
+			}
+
+			const double copy_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - copy_start).count() / copy_count;
+
+			if (copy_ns > round_trip_ns)
+			{
+				break;
+			}
+
+			result = size;
+		}
+
+		rsx_log.notice("DMA offload: worker round trip takes %.0fns, copies up to %u bytes are done immediately", round_trip_ns, result);
+		return result;
+	}
+
+	dma_manager::offload_thread& dma_manager::get_copy_worker() const
+	{
+		// Least busy copy worker, or the first worker if there are none
+		offload_thread* result = m_workers[0].get();
+
+		for (u32 i = 1; i < m_workers.size(); i++)
 		{
-			m_thread->m_enqueued_count++;
-			m_thread->m_work_queue.push(dst, src, length);
+			if (i == 1 || m_workers[i]->pending() < result->pending())
+			{
+				result = m_workers[i].get();
+			}
 		}
+
+		return *result;
 	}
 
-	void dma_manager::copy(void *dst, void *src, u32 length) const
+	// General transport
+	void dma_manager::copy(void *dst, std::vector<u8>& src, u32 length) const
 	{
-		if (length <= max_immediate_transfer_size || !g_cfg.video.multithreaded_rsx)
+		if (length > max_immediate_transfer_size && !m_workers.empty() && get_copy_worker().try_enqueue(dst, src, length))
 		{
-			const u32 vm_addr = vm::try_get_addr(src).first;
-			rsx::reservation_lock<true, 1> rsx_lock(vm_addr, length, g_cfg.video.strict_rendering_mode && vm_addr);
-			std::memcpy(dst, src, length);
+			m_offloaded_count++;
+			m_offloaded_bytes += length;
+			return;
 		}
-		else
+
+		m_immediate_count++;
+		std::memcpy(dst, src.data(), length);
+	}
+
+	void dma_manager::copy(void *dst, void *src, u32 length) const
+	{
+		if (length > max_immediate_transfer_size && !m_workers.empty() && get_copy_worker().try_enqueue(dst, src, length))
 		{
-			m_thread->m_enqueued_count++;
-			m_thread->m_work_queue.push(dst, src, length);
+			m_offloaded_count++;
+			m_offloaded_bytes += length;
+			return;
 		}
+
+		// Done immediately when small, or when the workers are too far behind
+		m_immediate_count++;
+
+		const u32 vm_addr = vm::try_get_addr(src).first;
+		rsx::reservation_lock<true, 1> rsx_lock(vm_addr, length, g_cfg.video.strict_rendering_mode && vm_addr);
+		std::memcpy(dst, src, length);
 	}
 
 	// Vertex utilities
 	void dma_manager::emulate_as_indexed(void *dst, rsx::primitive_type primitive, u32 count)
 	{
-		if (!g_cfg.video.multithreaded_rsx)
+		if (m_workers.empty())
 		{
 			write_index_array_for_non_indexed_non_native_primitive_to_buffer(
 				static_cast<char*>(dst), primitive, count);
 		}
 		else
 		{
-			m_thread->m_enqueued_count++;
-			m_thread->m_work_queue.push(dst, primitive, count);
+			m_workers[0]->enqueue(dst, primitive, count);
 		}
 	}
 
 	// Backend callback
 	void dma_manager::backend_ctrl(u32 request_code, void* args)
 	{
-		ensure(g_cfg.video.multithreaded_rsx);
+		ensure(g_cfg.video.multithreaded_rsx && !m_workers.empty());
 
-		m_thread->m_enqueued_count++;
-		m_thread->m_work_queue.push(request_code, args);
+		m_workers[0]->enqueue(request_code, args);
 	}
 
 	// Synchronization
@@ -152,7 +378,7 @@ namespace rsx
 	{
 		if (auto cpu = thread_ctrl::get_current())
 		{
-			return m_thread->current_thread_ == cpu;
+			return std::any_of(m_workers.cbegin(), m_workers.cend(), [&](const auto& worker) { return worker->current_thread_ == cpu; });
 		}
 
 		return false;
@@ -160,9 +386,12 @@ namespace rsx
 
 	bool dma_manager::sync() const
 	{
-		auto& _thr = *m_thread;
+		const auto is_busy = [this]()
+		{
+			return std::any_of(m_workers.cbegin(), m_workers.cend(), [](const auto& worker) { return worker->m_enqueued_count.load() > worker->m_processed_count.load(); });
+		};
 
-		if (_thr.m_enqueued_count.load() <= _thr.m_processed_count.load()) [[likely]]
+		if (!is_busy()) [[likely]]
 		{
 			// Nothing to do
 			return true;
@@ -176,7 +405,7 @@ namespace rsx
 				return false;
 			}
 
-			while (_thr.m_enqueued_count.load() > _thr.m_processed_count.load())
+			while (is_busy())
 			{
 				rsxthr->on_semaphore_acquire_wait();
 				utils::pause();
@@ -184,7 +413,7 @@ namespace rsx
 		}
 		else
 		{
-			while (_thr.m_enqueued_count.load() > _thr.m_processed_count.load())
+			while (is_busy())
 				utils::pause();
 		}
 
@@ -194,13 +423,22 @@ namespace rsx
 	void dma_manager::join()
 	{
 		sync();
-		*m_thread = thread_state::aborting;
+
+		for (auto& worker : m_workers)
+		{
+			*worker = thread_state::aborting;
+		}
 	}
 
 	void dma_manager::set_mem_fault_flag()
 	{
 		ensure(is_current_thread()); // "Access denied"
-		m_mem_fault_flag.release(true);
+
+		// Several workers may fault at once, the renderer can only recover one of them at a time
+		while (m_mem_fault_flag.exchange(true))
+		{
+			utils::pause();
+		}
 	}
 
 	void dma_manager::clear_mem_fault_flag()
@@ -212,7 +450,9 @@ namespace rsx
 	// Fault recovery
 	utils::address_range dma_manager::get_fault_range(bool writing) const
 	{
-		const auto m_current_job = ensure(m_thread->m_current_job);
+		const auto cpu = thread_ctrl::get_current();
+		const auto worker = std::find_if(m_workers.cbegin(), m_workers.cend(), [&](const auto& worker) { return worker->current_thread_ == cpu; });
+		const auto m_current_job = ensure(ensure(worker != m_workers.cend()) ? (*worker)->m_current_job : nullptr);
 
 		void *address = nullptr;
 		u32 range = m_current_job->length;
@@ -237,4 +477,16 @@ namespace rsx
 
 		return utils::address_range::start_length(vm::get_addr(address), range);
 	}
+
+	dma_manager::statistics dma_manager::get_statistics() const
+	{
+		return
+		{
+			.workers = ::size32(m_workers),
+			.max_immediate_transfer_size = max_immediate_transfer_size,
+			.immediate_transfers = m_immediate_count,
+			.offloaded_transfers = m_offloaded_count,
+			.offloaded_bytes = m_offloaded_bytes,
+		};
+	}
 }
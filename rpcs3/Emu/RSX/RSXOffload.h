@@ -4,6 +4,7 @@
 #include "Utilities/address_range.h"
 #include "gcm_enums.h"
 
+#include <memory>
 #include <vector>
 
 template <typename T>
@@ -47,20 +48,41 @@ namespace rsx
 				: type(op::callback), src(args), aux_param0(command)
 			{}
 
-			transport_packet(const transport_packet&) = delete;
-			transport_packet& operator=(const transport_packet&) = delete;
+			transport_packet() = default;
+
+			transport_packet(transport_packet&&) = default;
+			transport_packet& operator=(transport_packet&&) = default;
 		};
 
 		atomic_t<bool> m_mem_fault_flag = false;
 
+		// The first worker runs everything which must stay in order (index emulation, callbacks)
+		// The others only take raw copies, which do not depend on each other
 		struct offload_thread;
-		std::shared_ptr<named_thread<offload_thread>> m_thread;
+		std::vector<std::unique_ptr<named_thread<offload_thread>>> m_workers;
+
+		// Value determined by profiling on a Ryzen CPU, replaced by the host calibration in init()
+		u32 max_immediate_transfer_size = 3584;
 
-		// TODO: Improved benchmarks here; value determined by profiling on a Ryzen CPU, rounded to the nearest 512 bytes
-		const u32 max_immediate_transfer_size = 3584;
+		mutable atomic_t<u64> m_immediate_count = 0;
+		mutable atomic_t<u64> m_offloaded_count = 0;
+		mutable atomic_t<u64> m_offloaded_bytes = 0;
+
+		offload_thread& get_copy_worker() const;
+		static u32 calibrate_immediate_transfer_size(offload_thread& worker);
 
 	public:
-		dma_manager() = default;
+		struct statistics
+		{
+			u32 workers;
+			u32 max_immediate_transfer_size;
+			u64 immediate_transfers;
+			u64 offloaded_transfers;
+			u64 offloaded_bytes;
+		};
+
+		dma_manager();
+		~dma_manager();
 
 		// initialization
 		void init();
@@ -84,5 +106,8 @@ namespace rsx
 
 		// Fault recovery
 		utils::address_range get_fault_range(bool writing) const;
+
+		// Statistics
+		statistics get_statistics() const;
 	};
 }
@@ -750,6 +750,7 @@ namespace rsx
 	void thread::post_vblank_event(u64 post_event_time)
 	{
 		vblank_count++;
+		vblank_count.notify_all();
 
 		if (isHLE)
 		{
@@ -3327,6 +3328,14 @@ namespace rsx
 		return performance_counters.approximate_load;
 	}
 
+	u32 thread::get_vertex_cache_hit_rate()
+	{
+		const u64 lookups = performance_counters.vertex_cache_lookups.exchange(0);
+		const u64 hits = performance_counters.vertex_cache_hits.exchange(0);
+
+		return lookups ? static_cast<u32>(std::min<u64>(hits * 100 / lookups, 100)) : 0;
+	}
+
 	void thread::on_frame_end(u32 buffer, bool forced)
 	{
 		// Marks the end of a frame scope GPU-side
@@ -3383,6 +3392,9 @@ namespace rsx
 
 		// Save current state
 		m_queued_flip.stats = m_frame_stats;
+
+		performance_counters.vertex_cache_hits += m_frame_stats.vertex_cache_hits;
+		performance_counters.vertex_cache_lookups += m_frame_stats.vertex_cache_hits + m_frame_stats.vertex_cache_misses;
 		m_queued_flip.push(buffer);
 		m_queued_flip.skip_frame = skip_current_frame;
 
@@ -239,6 +239,8 @@ namespace rsx
 			FIFO::state state = FIFO::state::running;
 			u32 approximate_load = 0;
 			u32 sampled_frames = 0;
+			atomic_t<u64> vertex_cache_hits{ 0 };    // Vertex cache hits since the last hit rate query
+			atomic_t<u64> vertex_cache_lookups{ 0 }; // Vertex cache lookups since the last hit rate query
 		}
 		performance_counters;
 
@@ -535,6 +537,9 @@ namespace rsx
 		// Get RSX approximate load in %
 		u32 get_load();
 
+		// Get the share of vertex uploads found in the vertex cache since the last call in %
+		u32 get_vertex_cache_hit_rate();
+
 		// Get stats object
 		frame_statistics_t& get_stats() { return m_frame_stats; }
 
@@ -2,6 +2,7 @@
 #include "Core/RSXEngLock.hpp"
 #include "Core/RSXReservationLock.hpp"
 #include "RSXThread.h"
+#include "Common/write_tracking.h"
 
 namespace rsx
 {
@@ -23,6 +24,7 @@ namespace rsx
 		ZCULL_control::~ZCULL_control()
 		{
 			std::scoped_lock lock(m_pages_mutex);
+			rsx::write_tracking::batch protect_batch;
 
 			for (auto& block : m_locked_pages)
 			{
@@ -30,7 +32,7 @@ namespace rsx
 				{
 					if (p.second.prot != utils::protection::rw)
 					{
-						utils::memory_protect(vm::base(p.first), utils::c_page_size, utils::protection::rw);
+						rsx::write_tracking::protect(utils::address_range::start_length(p.first, utils::c_page_size), utils::protection::rw);
 					}
 				}
 
@@ -817,7 +819,7 @@ namespace rsx
 
 				if (page.prot == utils::protection::rw)
 				{
-					utils::memory_protect(vm::base(page_address), utils::c_page_size, utils::protection::no);
+					rsx::write_tracking::protect(utils::address_range::start_length(page_address, utils::c_page_size), utils::protection::no);
 					page.prot = utils::protection::no;
 				}
 			}
@@ -857,7 +859,9 @@ namespace rsx
 			rsx_log.warning("Reports area at location %s was accessed. ZCULL optimizations will be disabled.", location_tostring(location));
 			m_pages_accessed[location] = true;
 
-			// Unlock pages
+			// Unlock pages, adjacent pages are released with a single call
+			rsx::write_tracking::batch protect_batch;
+
 			for (auto& p : m_locked_pages[location])
 			{
 				const auto this_address = p.first;
@@ -865,7 +869,7 @@ namespace rsx
 
 				if (page.prot != utils::protection::rw)
 				{
-					utils::memory_protect(vm::base(this_address), utils::c_page_size, utils::protection::rw);
+					rsx::write_tracking::protect(utils::address_range::start_length(this_address, utils::c_page_size), utils::protection::rw);
 					page.prot = utils::protection::rw;
 				}
 
@@ -911,7 +915,8 @@ namespace rsx
 						else
 						{
 							// R/W to stale block, unload it and move on
-							utils::memory_protect(vm::base(page_address), utils::c_page_size, utils::protection::rw);
+							rsx::write_tracking::on_fault();
+							rsx::write_tracking::protect(utils::address_range::start_length(page_address, utils::c_page_size), utils::protection::rw);
 							m_locked_pages[location].erase(page_address);
 
 							return true;
@@ -99,6 +99,34 @@ namespace vk
 			break;
 		}
 	}
+
+	// Write the subdraws of a batched clause to the ring and submit them with as few indirect draws as the device allows
+	// fill(command, range, offset) sets up one command and returns the amount of vertices or indices it consumes
+	// On shadowed heaps, data_heap::sync copies the commands and makes them visible to the indirect command reads
+	template <typename command_type, typename fill_func, typename submit_func>
+	void emit_indirect_draws(const vk::command_buffer& cmd, vk::data_heap& ring, u32 max_draws_per_call, const rsx::draw_clause& clause, fill_func&& fill, submit_func submit)
+	{
+		const auto subranges = clause.get_subranges();
+		const u32 draw_count = ::size32(subranges);
+		const u32 upload_size = draw_count * ::size32(command_type{});
+
+		const VkDeviceSize offset = ring.alloc<16>(upload_size);
+		auto commands = static_cast<command_type*>(ring.map(offset, upload_size));
+
+		u32 data_offset = 0;
+		for (u32 i = 0; i < draw_count; ++i)
+		{
+			data_offset += fill(commands[i], subranges[i], data_offset);
+		}
+
+		ring.unmap();
+
+		for (u32 first = 0; first < draw_count; first += max_draws_per_call)
+		{
+			const u32 count = std::min(draw_count - first, max_draws_per_call);
+			submit(cmd, ring.heap->value, offset + first * sizeof(command_type), count, ::size32(command_type{}));
+		}
+	}
 }
 
 void VKGSRender::begin_render_pass()
@@ -875,12 +903,25 @@ void VKGSRender::emit_geometry(u32 sub_index)
 	m_current_frame->descriptor_set.bind(*m_current_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_program->pipeline_layout);
 	m_frame_stats.setup_time += m_profiler.duration();
 
+	// Batched clauses go out in one submission when possible; the commands are kept in the index ring
+	const bool use_indirect_draws = m_device->get_multi_draw_indirect_support();
+	const u32 max_indirect_draws = std::max(m_device->gpu().get_limits().maxDrawIndirectCount, 1u);
+
 	if (!upload_info.index_info)
 	{
 		if (draw_call.is_single_draw())
 		{
 			vkCmdDraw(*m_current_command_buffer, upload_info.vertex_draw_count, 1, 0, 0);
 		}
+		else if (use_indirect_draws)
+		{
+			vk::emit_indirect_draws<VkDrawIndirectCommand>(*m_current_command_buffer, m_index_buffer_ring_info, max_indirect_draws, draw_call,
+				[](VkDrawIndirectCommand& command, const rsx::draw_range_t& range, u32 vertex_offset)
+				{
+					command = { range.count, 1, vertex_offset, 0 };
+					return range.count;
+				}, vkCmdDrawIndirect);
+		}
 		else
 		{
 			u32 vertex_offset = 0;
@@ -904,6 +945,16 @@ void VKGSRender::emit_geometry(u32 sub_index)
 			const u32 index_count = upload_info.vertex_draw_count;
 			vkCmdDrawIndexed(*m_current_command_buffer, index_count, 1, 0, 0, 0);
 		}
+		else if (use_indirect_draws)
+		{
+			vk::emit_indirect_draws<VkDrawIndexedIndirectCommand>(*m_current_command_buffer, m_index_buffer_ring_info, max_indirect_draws, draw_call,
+				[&](VkDrawIndexedIndirectCommand& command, const rsx::draw_range_t& range, u32 index_offset)
+				{
+					const u32 count = get_index_count(draw_call.primitive, range.count);
+					command = { count, 1, index_offset, 0, 0 };
+					return count;
+				}, vkCmdDrawIndexedIndirect);
+		}
 		else
 		{
 			u32 vertex_offset = 0;
@@ -30,9 +30,11 @@ namespace vk
 	struct buffer_view;
 	struct program_cache;
 	struct pipeline_props;
+	class data_heap;
 
 	using vertex_cache = rsx::vertex_cache::default_vertex_cache<rsx::vertex_cache::uploaded_range<VkFormat>, VkFormat>;
 	using weak_vertex_cache = rsx::vertex_cache::weak_vertex_cache<VkFormat>;
+	using strict_vertex_cache = rsx::vertex_cache::strict_vertex_cache<VkFormat, vk::data_heap>;
 	using null_vertex_cache = vertex_cache;
 
 	using shader_cache = rsx::shaders_cache<vk::pipeline_props, vk::program_cache>;
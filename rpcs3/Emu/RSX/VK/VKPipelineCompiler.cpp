@@ -3,6 +3,8 @@
 #include "VKRenderPass.h"
 #include "vkutils/device.h"
 #include "Utilities/Thread.h"
+#include "Utilities/job_system.h"
+#include "Emu/Cell/timers.hpp"
 
 #include <thread>
 
@@ -10,10 +12,223 @@
 
 namespace vk
 {
+	// Driver-side pipeline cache persisted across sessions. One blob is kept per device and driver version.
+	class pipeline_cache
+	{
+		// Minimum time between two periodic saves (usec)
+		static constexpr u64 save_interval = 30'000'000;
+
+		// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		struct cache_header
+		{
+			u32 header_size;
+			u32 header_version;
+			u32 vendor_id;
+			u32 device_id;
+			u8 uuid[VK_UUID_SIZE];
+		};
+
+		const vk::render_device* m_device = nullptr;
+		VkPipelineCache m_cache = VK_NULL_HANDLE;
+		std::string m_path;
+
+		atomic_t<u32> m_dirty_count = 0;
+		atomic_t<u64> m_last_save_time = 0;
+		shared_mutex m_save_lock;
+
+		bool validate(const std::vector<u8>& data) const
+		{
+			const auto& props = m_device->gpu().get_properties();
+			cache_header header;
+
+			if (data.size() < sizeof(header))
+			{
+				return false;
+			}
+
+			std::memcpy(&header, data.data(), sizeof(header));
+
+			return header.header_size >= sizeof(header) &&
+				header.header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+				header.vendor_id == props.vendorID &&
+				header.device_id == props.deviceID &&
+				std::memcmp(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+
+	public:
+		void create(const vk::render_device* pdev)
+		{
+			m_device = pdev;
+
+			if (!g_cfg.video.disable_on_disk_shader_cache)
+			{
+				const auto& props = pdev->gpu().get_properties();
+				std::string uuid;
+
+				for (u8 byte : props.pipelineCacheUUID)
+				{
+					fmt::append(uuid, "%02x", byte);
+				}
+
+				const std::string dir = fs::get_cache_dir() + "shaders_cache/vulkan/";
+				m_path = dir + fmt::format("%04x_%04x_%08x_%s.bin", props.vendorID, props.deviceID, props.driverVersion, uuid);
+
+				if (!fs::is_dir(dir) && !fs::create_path(dir))
+				{
+					rsx_log.error("Failed to create pipeline cache directory '%s' (%s)", dir, fs::g_tls_error);
+					m_path.clear();
+				}
+			}
+
+			std::vector<u8> data;
+
+			if (fs::file file; !m_path.empty() && file.open(m_path))
+			{
+				data = file.to_vector<u8>();
+
+				if (!validate(data))
+				{
+					rsx_log.warning("Pipeline cache '%s' is invalid or was created by a different driver and will be discarded.", m_path);
+					data.clear();
+				}
+			}
+
+			VkPipelineCacheCreateInfo info = {};
+			info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			info.initialDataSize = data.size();
+			info.pInitialData = data.empty() ? nullptr : data.data();
+
+			VkResult result = vkCreatePipelineCache(*m_device, &info, nullptr, &m_cache);
+
+			if (result != VK_SUCCESS && !data.empty())
+			{
+				// Retry with an empty cache if the driver rejected the blob
+				rsx_log.warning("The driver rejected the pipeline cache '%s' (0x%x), starting with an empty cache.", m_path, static_cast<s32>(result));
+
+				data.clear();
+				info.initialDataSize = 0;
+				info.pInitialData = nullptr;
+				result = vkCreatePipelineCache(*m_device, &info, nullptr, &m_cache);
+			}
+
+			if (result != VK_SUCCESS)
+			{
+				// Pipelines can still be created without a cache
+				rsx_log.error("Failed to create a pipeline cache (0x%x)", static_cast<s32>(result));
+				m_cache = VK_NULL_HANDLE;
+				m_path.clear();
+			}
+			else if (!data.empty())
+			{
+				rsx_log.notice("Loaded %u bytes of pipeline cache from '%s'", data.size(), m_path);
+			}
+
+			m_dirty_count = 0;
+			m_last_save_time = get_system_time();
+		}
+
+		void destroy()
+		{
+			if (!m_cache)
+			{
+				return;
+			}
+
+			save(true);
+
+			vkDestroyPipelineCache(*m_device, m_cache, nullptr);
+			m_cache = VK_NULL_HANDLE;
+			m_device = nullptr;
+			m_path.clear();
+		}
+
+		void notify_pipeline_created()
+		{
+			m_dirty_count++;
+		}
+
+		bool is_dirty() const
+		{
+			return m_dirty_count != 0;
+		}
+
+		void save(bool force)
+		{
+			if (m_path.empty() || !m_dirty_count)
+			{
+				return;
+			}
+
+			if (!force && get_system_time() - m_last_save_time < save_interval)
+			{
+				return;
+			}
+
+			std::unique_lock lock(m_save_lock, std::defer_lock);
+
+			if (force)
+			{
+				lock.lock();
+			}
+			else if (!lock.try_lock())
+			{
+				// Another compiler thread is already writing the cache
+				return;
+			}
+
+			const u32 pending = m_dirty_count.exchange(0);
+			if (!pending)
+			{
+				return;
+			}
+
+			m_last_save_time = get_system_time();
+
+			usz size = 0;
+			std::vector<u8> data;
+			VkResult result;
+
+			// The cache may grow between the two calls, in which case the driver returns VK_INCOMPLETE
+			do
+			{
+				if ((result = vkGetPipelineCacheData(*m_device, m_cache, &size, nullptr)) != VK_SUCCESS || !size)
+				{
+					break;
+				}
+
+				data.resize(size);
+				result = vkGetPipelineCacheData(*m_device, m_cache, &size, data.data());
+			}
+			while (result == VK_INCOMPLETE);
+
+			if (result != VK_SUCCESS || !size)
+			{
+				rsx_log.error("Failed to retrieve pipeline cache data from the driver (0x%x)", static_cast<s32>(result));
+				return;
+			}
+
+			fs::pending_file temp(m_path);
+
+			if (!temp.file || temp.file.write(data.data(), size) != size || !temp.commit())
+			{
+				rsx_log.error("Failed to save pipeline cache to '%s' (%s)", m_path, fs::g_tls_error);
+				return;
+			}
+
+			rsx_log.notice("Saved %u bytes of pipeline cache to '%s' (%u new pipelines)", size, m_path, pending);
+		}
+
+		operator VkPipelineCache() const
+		{
+			return m_cache;
+		}
+	};
+
 	// Global list of worker threads
 	std::unique_ptr<named_thread_group<pipe_compiler>> g_pipe_compilers;
 	int g_num_pipe_compilers = 0;
 	atomic_t<int> g_compiler_index{};
+	pipeline_cache g_pipeline_cache;
 
 	pipe_compiler::pipe_compiler()
 	{
@@ -36,6 +251,9 @@ namespace vk
 		{
 			for (auto&& job : m_work_queue.pop_all())
 			{
+				// Count against the process-wide compilation budget
+				utils::job_slot slot(utils::job_class::foreground);
+
 				if (job.is_graphics_job)
 				{
 					auto compiled = int_compile_graphics_pipe(job.graphics_data, job.graphics_modules, job.pipe_layout, job.inputs, {});
@@ -48,14 +266,19 @@ namespace vk
 				}
 			}
 
-			thread_ctrl::wait_on(m_work_queue, nullptr);
+			// Periodically write back newly compiled pipelines so they survive a crash
+			g_pipeline_cache.save(false);
+
+			const u64 timeout = g_pipeline_cache.is_dirty() ? 1'000'000 : u64{umax};
+			thread_ctrl::wait_on(m_work_queue, nullptr, timeout);
 		}
 	}
 
 	std::unique_ptr<glsl::program> pipe_compiler::int_compile_compute_pipe(const VkComputePipelineCreateInfo& create_info, VkPipelineLayout pipe_layout)
 	{
 		VkPipeline pipeline;
-		vkCreateComputePipelines(*g_render_device, nullptr, 1, &create_info, nullptr, &pipeline);
+		vkCreateComputePipelines(*g_render_device, g_pipeline_cache, 1, &create_info, nullptr, &pipeline);
+		g_pipeline_cache.notify_pipeline_created();
 		return std::make_unique<vk::glsl::program>(*m_device, pipeline, pipe_layout);
 	}
 
@@ -63,7 +286,9 @@ namespace vk
 			const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs)
 	{
 		VkPipeline pipeline;
-		CHECK_RESULT(vkCreateGraphicsPipelines(*m_device, nullptr, 1, &create_info, NULL, &pipeline));
+		CHECK_RESULT(vkCreateGraphicsPipelines(*m_device, g_pipeline_cache, 1, &create_info, NULL, &pipeline));
+		g_pipeline_cache.notify_pipeline_created();
+
 		auto result = std::make_unique<vk::glsl::program>(*m_device, pipeline, pipe_layout, vs_inputs, fs_inputs);
 		result->link();
 		return result;
@@ -235,6 +460,9 @@ namespace vk
 		ensure(num_worker_threads >= 1);
 		ensure(g_render_device); // "Cannot initialize pipe compiler before creating a logical device"
 
+		// Load the driver pipeline cache before any worker can compile
+		g_pipeline_cache.create(g_render_device);
+
 		// Create the thread pool
 		g_pipe_compilers = std::make_unique<named_thread_group<pipe_compiler>>("RSX.W", num_worker_threads);
 		g_num_pipe_compilers = num_worker_threads;
@@ -249,6 +477,9 @@ namespace vk
 	void destroy_pipe_compiler()
 	{
 		g_pipe_compilers.reset();
+
+		// Flush and release the driver pipeline cache once all workers are gone
+		g_pipeline_cache.destroy();
 	}
 
 	pipe_compiler* get_pipe_compiler()
@@ -132,7 +132,7 @@ void VKGSRender::advance_queued_frames()
 
 	vk::remove_unused_framebuffers();
 
-	m_vertex_cache->purge();
+	m_vertex_cache->on_frame_end();
 	m_current_frame->tag_frame_end(m_attrib_ring_info.get_current_put_pos_minus_one(),
 		m_vertex_env_ring_info.get_current_put_pos_minus_one(),
 		m_fragment_env_ring_info.get_current_put_pos_minus_one(),
@@ -704,19 +704,19 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 
 			flush_command_queue(true);
 			auto src = sshot_vkbuf.map(0, sshot_size);
-			std::vector<u8> sshot_frame(sshot_size);
-			memcpy(sshot_frame.data(), src, sshot_size);
+			m_capture_frame.resize(sshot_size);
+			memcpy(m_capture_frame.data(), src, sshot_size);
 			sshot_vkbuf.unmap();
 
 			const bool is_bgra = image_to_flip->format() == VK_FORMAT_B8G8R8A8_UNORM;
 
 			if (g_user_asked_for_screenshot.exchange(false))
 			{
-				m_frame->take_screenshot(std::move(sshot_frame), buffer_width, buffer_height, is_bgra);
+				m_frame->take_screenshot(std::move(m_capture_frame), buffer_width, buffer_height, is_bgra);
 			}
 			else
 			{
-				m_frame->present_frame(sshot_frame, buffer_width, buffer_height, is_bgra);
+				m_frame->present_frame(m_capture_frame, buffer_width, buffer_height, is_bgra);
 			}
 		}
 	}
@@ -810,6 +810,9 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 			println(fmt::format("Temporary texture memory: %3dM", tmp_texture_memory_size));
 			println(fmt::format("Flush requests: %13d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate));
 			println(fmt::format("Texture uploads: %14u (%u from CPU - %02u%%)", num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio));
+
+			const auto write_tracking = rsx::write_tracking::get_frame_stats();
+			println(fmt::format("Write faults: %15u (%u block releases), %u protect calls for %u requests", write_tracking.faults, write_tracking.neighbourhood_faults, write_tracking.protect_calls, write_tracking.protect_requests));
 		}
 
 		direct_fbo->release();
@@ -238,7 +238,6 @@ vk::vertex_upload_info VKGSRender::upload_vertex_data()
 	{
 		//Check if cacheable
 		//Only data in the 'persistent' block may be cached
-		//TODO: make vertex cache keep local data beyond frame boundaries and hook notify command
 		bool in_cache = false;
 		bool to_store = false;
 		u32  storage_address = -1;
@@ -254,11 +253,13 @@ vk::vertex_upload_info VKGSRender::upload_vertex_data()
 				ensure(cached->local_address == storage_address);
 
 				in_cache = true;
+				m_frame_stats.vertex_cache_hits++;
 				persistent_range_base = cached->offset_in_heap;
 			}
 			else
 			{
 				to_store = true;
+				m_frame_stats.vertex_cache_misses++;
 			}
 		}
 
@@ -143,9 +143,25 @@ namespace vk
 			vkCmdCopyBuffer(cmd, shadow->value, heap->value, ::size32(dirty_ranges), dirty_ranges.data());
 			dirty_ranges.clear();
 
+			// Cover every way the heap contents can be consumed, index and indirect data is read before the shaders run
+			VkPipelineStageFlags dst_stage = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+			VkAccessFlags dst_access = VK_ACCESS_SHADER_READ_BIT;
+
+			if (heap->info.usage & (VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT))
+			{
+				dst_stage |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+				dst_access |= VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+			}
+
+			if (heap->info.usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)
+			{
+				dst_stage |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+				dst_access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			}
+
 			insert_buffer_memory_barrier(cmd, heap->value, 0, heap->size(),
-				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+				VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage,
+				VK_ACCESS_TRANSFER_WRITE_BIT, dst_access);
 		}
 	}
 
@@ -354,6 +354,11 @@ namespace vk
 		return props.limits;
 	}
 
+	const VkPhysicalDeviceProperties& physical_device::get_properties() const
+	{
+		return props;
+	}
+
 	physical_device::operator VkPhysicalDevice() const
 	{
 		return dev;
@@ -502,6 +507,12 @@ namespace vk
 		enabled_features.textureCompressionBC = VK_TRUE;
 		enabled_features.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
 
+		if (pgpu->features.multiDrawIndirect)
+		{
+			// Optional, used to submit batched draw clauses with a single command
+			enabled_features.multiDrawIndirect = VK_TRUE;
+		}
+
 		// Optionally disable unsupported stuff
 		if (!pgpu->features.shaderStorageImageMultisample || !pgpu->features.shaderStorageImageWriteWithoutFormat)
 		{
@@ -92,6 +92,7 @@ namespace vk
 		const VkQueueFamilyProperties& get_queue_properties(u32 queue);
 		const VkPhysicalDeviceMemoryProperties& get_memory_properties() const;
 		const VkPhysicalDeviceLimits& get_limits() const;
+		const VkPhysicalDeviceProperties& get_properties() const;
 
 		operator VkPhysicalDevice() const;
 		operator VkInstance() const;
@@ -145,6 +146,7 @@ namespace vk
 		bool get_alpha_to_one_support() const { return pgpu->features.alphaToOne != VK_FALSE; }
 		bool get_anisotropic_filtering_support() const { return pgpu->features.samplerAnisotropy != VK_FALSE; }
 		bool get_wide_lines_support() const { return pgpu->features.wideLines != VK_FALSE; }
+		bool get_multi_draw_indirect_support() const { return pgpu->features.multiDrawIndirect != VK_FALSE; }
 		bool get_conditional_render_support() const { return pgpu->conditional_render_support; }
 		bool get_unrestricted_depth_range_support() const { return pgpu->unrestricted_depth_range_support; }
 		bool get_external_memory_host_support() const { return pgpu->external_memory_host_support; }
@@ -2,8 +2,10 @@
 #include "Utilities/File.h"
 #include "Utilities/lockless.h"
 #include "Utilities/Thread.h"
+#include "Utilities/job_system.h"
 #include "Common/bitfield.hpp"
 #include "Emu/System.h"
+#include "Emu/Memory/vm.h"
 #include "Emu/cache_utils.hpp"
 #include "Program/ProgramStateCache.h"
 #include "Common/texture_cache_checker.h"
@@ -15,6 +17,8 @@
 #include "util/sysinfo.hpp"
 #include "util/fnv_hash.hpp"
 
+#include "xxhash.h"
+
 namespace rsx
 {
 	template <typename pipeline_storage_type, typename backend_storage>
@@ -165,7 +169,7 @@ namespace rsx
 			}
 			else
 			{
-				named_thread_group workers("RSX Worker ", nb_workers, [&]()
+				const auto workers = utils::start_jobs(utils::job_class::foreground, nb_workers, [&](u32)
 				{
 					worker(entry_count);
 				});
@@ -187,6 +191,8 @@ namespace rsx
 						dlg->set_value(step, current_progress);
 					}
 				}
+
+				workers->wait();
 			}
 
 			if (!Emu.IsStopped())
@@ -263,7 +269,7 @@ namespace rsx
 
 			// Preload everything needed to compile the shaders
 			unpacked_type unpacked;
-			uint nb_workers = g_cfg.video.renderer == video_renderer::vulkan ? utils::get_thread_count() : 1;
+			uint nb_workers = g_cfg.video.renderer == video_renderer::vulkan ? utils::get_job_budget() : 1;
 
 			load_shaders(nb_workers, unpacked, directory_path, entries, entry_count, dlg);
 
@@ -455,11 +461,11 @@ namespace rsx
 			virtual storage_type* find_vertex_range(uptr /*local_addr*/, upload_format, u32 /*data_length*/) { return nullptr; }
 			virtual void store_range(uptr /*local_addr*/, upload_format, u32 /*data_length*/, u32 /*offset_in_heap*/) {}
 			virtual void purge() {}
+			virtual void on_frame_end() {}
 		};
 
 		// A weak vertex cache with no data checks or memory range locks
 		// Of limited use since contents are only guaranteed to be valid once per frame
-		// TODO: Strict vertex cache with range locks
 		template <typename upload_format>
 		struct uploaded_range
 		{
@@ -508,6 +514,180 @@ namespace rsx
 			{
 				vertex_ranges.clear();
 			}
+
+			void on_frame_end() override
+			{
+				purge();
+			}
+		};
+
+		// A vertex cache keeping uploads across frames
+		// Guest memory is hashed again on the first use in a frame, so data rewritten by the application is uploaded again
+		// Ranges used by frames still in flight are pinned in the heap, a heap which runs short on space becomes critical
+		// and the renderer purges the cache after flushing
+		template <typename upload_format, typename heap_type>
+		class strict_vertex_cache : public default_vertex_cache<uploaded_range<upload_format>, upload_format>
+		{
+			using storage_type = uploaded_range<upload_format>;
+
+		private:
+			struct cache_entry
+			{
+				storage_type range;
+				u64 heap_pos;        // See data_heap::get_allocated_pos
+				u64 data_hash;
+				u64 validated_frame; // Last frame the hash was checked in
+			};
+
+			heap_type& m_heap;
+			std::unordered_map<uptr, std::vector<cache_entry>> m_entries;
+
+			// Oldest heap position used by the current frame and each of the frames which may still be in flight
+			std::vector<u64> m_frame_pins;
+			u64 m_pinned_pos = umax;
+			u64 m_frame = 0;
+
+			static u64 hash_range(uptr local_addr, u32 data_length)
+			{
+				return XXH64(vm::base(static_cast<u32>(local_addr)), data_length, 0);
+			}
+
+			// Too old entries are dropped early so that a pinned range always has half of the heap ahead of it
+			bool is_resident(const cache_entry& entry) const
+			{
+				return (m_heap.get_allocated_pos() - entry.heap_pos) <= (m_heap.size() / 2);
+			}
+
+			bool is_valid(cache_entry& entry)
+			{
+				if (!is_resident(entry))
+				{
+					return false;
+				}
+
+				if (entry.validated_frame != m_frame)
+				{
+					const u32 addr = static_cast<u32>(entry.range.local_address);
+
+					if (!vm::check_addr(addr, vm::page_readable, entry.range.data_length) ||
+						hash_range(addr, entry.range.data_length) != entry.data_hash)
+					{
+						return false;
+					}
+
+					entry.validated_frame = m_frame;
+				}
+
+				return true;
+			}
+
+			void pin(u64 pos)
+			{
+				u64& frame_pin = m_frame_pins[m_frame % m_frame_pins.size()];
+				frame_pin = std::min(frame_pin, pos);
+
+				if (pos < m_pinned_pos)
+				{
+					m_pinned_pos = pos;
+					m_heap.pin(pos);
+				}
+			}
+
+		public:
+			strict_vertex_cache(heap_type& heap, u32 frames_in_flight)
+				: m_heap(heap)
+				, m_frame_pins(frames_in_flight + 1, umax)
+			{
+			}
+
+			storage_type* find_vertex_range(uptr local_addr, upload_format fmt, u32 data_length) override
+			{
+				const auto found = m_entries.find(local_addr);
+
+				if (found == m_entries.end())
+				{
+					return nullptr;
+				}
+
+				auto& list = found->second;
+
+				for (auto it = list.begin(); it != list.end(); ++it)
+				{
+					// NOTE: This has to match exactly, see weak_vertex_cache
+					if (it->range.buffer_format != fmt || it->range.data_length != data_length)
+					{
+						continue;
+					}
+
+					if (!is_valid(*it))
+					{
+						list.erase(it);
+						return nullptr;
+					}
+
+					pin(it->heap_pos);
+					return &it->range;
+				}
+
+				return nullptr;
+			}
+
+			void store_range(uptr local_addr, upload_format fmt, u32 data_length, u32 offset_in_heap) override
+			{
+				// Called right after the allocation, find the position of its offset within the last heap length
+				const u64 end = m_heap.get_allocated_pos();
+
+				cache_entry entry = {};
+				entry.range.buffer_format = fmt;
+				entry.range.data_length = data_length;
+				entry.range.local_address = local_addr;
+				entry.range.offset_in_heap = offset_in_heap;
+				entry.heap_pos = end - (end - offset_in_heap) % m_heap.size();
+				entry.data_hash = hash_range(local_addr, data_length);
+				entry.validated_frame = m_frame;
+
+				auto& list = m_entries[local_addr];
+
+				std::erase_if(list, [&](const cache_entry& e)
+				{
+					return e.range.buffer_format == fmt && e.range.data_length == data_length;
+				});
+
+				list.push_back(entry);
+			}
+
+			void purge() override
+			{
+				m_entries.clear();
+
+				std::fill(m_frame_pins.begin(), m_frame_pins.end(), umax);
+				m_pinned_pos = umax;
+				m_heap.pin(umax);
+			}
+
+			void on_frame_end() override
+			{
+				m_frame++;
+				m_frame_pins[m_frame % m_frame_pins.size()] = umax;
+
+				// Release the ranges only used by frames which have completed
+				m_pinned_pos = *std::min_element(m_frame_pins.begin(), m_frame_pins.end());
+				m_heap.pin(m_pinned_pos);
+
+				for (auto it = m_entries.begin(); it != m_entries.end();)
+				{
+					std::erase_if(it->second, [this](const cache_entry& e) { return !is_resident(e); });
+
+					if (it->second.empty())
+					{
+						it = m_entries.erase(it);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
 		};
 	}
 }
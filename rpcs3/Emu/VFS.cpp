@@ -25,6 +25,34 @@ struct vfs_directory
 	std::vector<std::pair<std::string, vfs_directory>> dirs{};
 };
 
+struct vfs_resolved_path
+{
+	std::string path{};
+	std::string out_path{};
+	std::vector<std::string> dirs{};
+};
+
+struct vfs_cached_stat
+{
+	fs::stat_t info{};
+
+	// fs::error::ok if the file exists
+	fs::error error{};
+};
+
+struct vfs_path_hash
+{
+	using is_transparent = void;
+
+	usz operator()(std::string_view path) const noexcept
+	{
+		return std::hash<std::string_view>{}(path);
+	}
+};
+
+template <typename T>
+using vfs_path_map = std::unordered_map<std::string, T, vfs_path_hash, std::equal_to<>>;
+
 struct vfs_manager
 {
 	shared_mutex mutex{};
@@ -32,6 +60,62 @@ struct vfs_manager
 	// VFS root
 	vfs_directory root{};
 
+	// Maximum amount of entries of each cache, they are flushed when full
+	static constexpr usz max_cached_paths = 8192;
+
+	// Guest path resolution cache, only modified with mutex locked (shared lock for insertion)
+	shared_mutex cache_mutex{};
+	vfs_path_map<vfs_resolved_path> path_cache{};
+
+	// Host metadata cache for read-only mount points
+	vfs_path_map<vfs_cached_stat> stat_cache{};
+
+	// Host directories also mounted through a writable mount point (e.g. /app_home sharing the directory of /dev_bdvd)
+	// Their metadata can change while the game runs, so it is never cached
+	std::vector<std::string> writable_dirs{};
+
+	atomic_t<u64> path_hits{0};
+	atomic_t<u64> path_misses{0};
+	atomic_t<u64> stat_hits{0};
+	atomic_t<u64> stat_misses{0};
+
+	// Drop all cached entries (mount table changed, requires mutex)
+	void clear_cache()
+	{
+		std::vector<std::string> dirs;
+
+		const auto find_writable_dirs = [&](auto&& self, const vfs_directory& dir, const std::string& vpath) -> void
+		{
+			if (!dir.path.empty() && !(lv2_fs_object::get_mp(vpath)->flags & lv2_mp_flag::read_only))
+			{
+				dirs.emplace_back(dir.path);
+			}
+
+			for (const auto& [name, sub] : dir.dirs)
+			{
+				self(self, sub, vpath + "/" + name);
+			}
+		};
+
+		find_writable_dirs(find_writable_dirs, root, "");
+
+		std::lock_guard lock(cache_mutex);
+
+		writable_dirs = std::move(dirs);
+
+		if (const u64 lookups = path_hits + path_misses)
+		{
+			vfs_log.notice("Path cache: %u/%u hits, stat cache: %u/%u hits", path_hits.load(), lookups, stat_hits.load(), stat_hits + stat_misses);
+		}
+
+		path_cache.clear();
+		stat_cache.clear();
+		path_hits = 0;
+		path_misses = 0;
+		stat_hits = 0;
+		stat_misses = 0;
+	}
+
 	SAVESTATE_INIT_POS(48);
 };
 
@@ -79,6 +163,8 @@ bool vfs::mount(std::string_view vpath, std::string_view path, bool is_dir)
 			if (path == "/") // Special
 				list.back()->path = "/";
 
+			table.clear_cache();
+
 			vfs_log.notice("Mounted path \"%s\" to \"%s\"", vpath_backup, list.back()->path);
 			return true;
 		}
@@ -186,15 +272,13 @@ bool vfs::unmount(std::string_view vpath)
 	};
 	unmount_children(table.root, 0);
 
+	table.clear_cache();
+
 	return true;
 }
 
-std::string vfs::get(std::string_view vpath, std::vector<std::string>* out_dir, std::string* out_path)
+static std::string resolve_path(const vfs_manager& table, std::string_view vpath, std::vector<std::string>* out_dir, std::string* out_path)
 {
-	auto& table = g_fxo->get<vfs_manager>();
-
-	reader_lock lock(table.mutex);
-
 	// Resulting path fragments: decoded ones
 	std::vector<std::string_view> result;
 	result.reserve(vpath.size() / 2);
@@ -363,6 +447,58 @@ std::string vfs::get(std::string_view vpath, std::vector<std::string>* out_dir,
 	return std::string{result_base} + fmt::merge(escaped, "/");
 }
 
+std::string vfs::get(std::string_view vpath, std::vector<std::string>* out_dir, std::string* out_path)
+{
+	auto& table = g_fxo->get<vfs_manager>();
+
+	// Mount table lock also prevents stale entries from being inserted after clear_cache()
+	reader_lock lock(table.mutex);
+
+	vfs_resolved_path resolved;
+	bool cached = false;
+
+	{
+		reader_lock cache_lock(table.cache_mutex);
+
+		if (auto found = table.path_cache.find(vpath); found != table.path_cache.end())
+		{
+			resolved = found->second;
+			cached = true;
+		}
+	}
+
+	if (!cached)
+	{
+		table.path_misses++;
+		resolved.path = resolve_path(table, vpath, &resolved.dirs, &resolved.out_path);
+
+		std::lock_guard cache_lock(table.cache_mutex);
+
+		if (table.path_cache.size() >= vfs_manager::max_cached_paths)
+		{
+			table.path_cache.clear();
+		}
+
+		table.path_cache.emplace(vpath, resolved);
+	}
+	else
+	{
+		table.path_hits++;
+	}
+
+	if (out_dir)
+	{
+		out_dir->insert(out_dir->end(), std::make_move_iterator(resolved.dirs.begin()), std::make_move_iterator(resolved.dirs.end()));
+	}
+
+	if (out_path && !resolved.out_path.empty())
+	{
+		*out_path = std::move(resolved.out_path);
+	}
+
+	return std::move(resolved.path);
+}
+
 using char2 = char8_t;
 
 std::string vfs::retrieve(std::string_view path, const vfs_directory* node, std::vector<std::string_view>* mount_path)
@@ -925,6 +1061,64 @@ std::string vfs::host::hash_path(const std::string& path, const std::string& dev
 	return fmt::format(u8"%s/＄%s%s", dev_root, fmt::base57(std::hash<std::string>()(path)), fmt::base57(utils::get_unique_tsc()));
 }
 
+bool vfs::host::stat(const std::string& path, fs::stat_t& info, const lv2_fs_mount_point* mp)
+{
+	if (!mp || !(mp->flags & lv2_mp_flag::read_only))
+	{
+		return fs::stat(path, info);
+	}
+
+	auto& table = g_fxo->get<vfs_manager>();
+
+	{
+		reader_lock lock(table.cache_mutex);
+
+		if (std::any_of(table.writable_dirs.begin(), table.writable_dirs.end(), [&](const std::string& dir) { return path.starts_with(dir); }))
+		{
+			return fs::stat(path, info);
+		}
+
+		if (auto found = table.stat_cache.find(path); found != table.stat_cache.end())
+		{
+			table.stat_hits++;
+			info = found->second.info;
+			fs::g_tls_error = found->second.error;
+			return found->second.error == fs::error::ok;
+		}
+	}
+
+	table.stat_misses++;
+
+	vfs_cached_stat entry{};
+
+	if (!fs::stat(path, entry.info))
+	{
+		entry.error = fs::g_tls_error;
+	}
+
+	info = entry.info;
+
+	std::lock_guard lock(table.cache_mutex);
+
+	if (table.stat_cache.size() >= vfs_manager::max_cached_paths)
+	{
+		table.stat_cache.clear();
+	}
+
+	table.stat_cache.emplace(path, entry);
+
+	fs::g_tls_error = entry.error;
+	return entry.error == fs::error::ok;
+}
+
+static void invalidate_stat_cache()
+{
+	auto& table = g_fxo->get<vfs_manager>();
+
+	std::lock_guard lock(table.cache_mutex);
+	table.stat_cache.clear();
+}
+
 bool vfs::host::rename(const std::string& from, const std::string& to, const lv2_fs_mount_point* mp, bool overwrite)
 {
 	// Lock mount point, close file descriptors, retry
@@ -1005,12 +1199,19 @@ bool vfs::host::rename(const std::string& from, const std::string& to, const lv2
 		}
 	});
 
+	if (res)
+	{
+		invalidate_stat_cache();
+	}
+
 	fs::g_tls_error = fs_error;
 	return res;
 }
 
 bool vfs::host::unlink(const std::string& path, [[maybe_unused]] const std::string& dev_root)
 {
+	invalidate_stat_cache();
+
 #ifdef _WIN32
 	if (auto device = fs::get_virtual_device(path))
 	{
@@ -1045,6 +1246,8 @@ bool vfs::host::unlink(const std::string& path, [[maybe_unused]] const std::stri
 
 bool vfs::host::remove_all(const std::string& path, [[maybe_unused]] const std::string& dev_root, [[maybe_unused]] const lv2_fs_mount_point* mp, bool remove_root)
 {
+	invalidate_stat_cache();
+
 #ifdef _WIN32
 	if (remove_root)
 	{
@@ -7,6 +7,11 @@
 struct lv2_fs_mount_point;
 struct vfs_directory;
 
+namespace fs
+{
+	struct stat_t;
+}
+
 namespace vfs
 {
 	// Mount VFS device
@@ -33,6 +38,9 @@ namespace vfs
 		// For internal use (don't use)
 		std::string hash_path(const std::string& path, const std::string& dev_root);
 
+		// Call fs::stat, cached on read-only mount points (fs::g_tls_error is set on failure)
+		bool stat(const std::string& path, fs::stat_t& info, const lv2_fs_mount_point* mp);
+
 		// Call fs::rename with retry on access error
 		bool rename(const std::string& from, const std::string& to, const lv2_fs_mount_point* mp, bool overwrite);
 
@@ -0,0 +1,281 @@
+#include "stdafx.h"
+#include "cache_builder.h"
+#include "System.h"
+#include "rpcs3_version.h"
+#include "system_utils.hpp"
+#include "vfs_config.h"
+#include "Loader/PSF.h"
+#include "Utilities/Thread.h"
+#include "Utilities/job_system.h"
+
+#include "util/sysinfo.hpp"
+#include "util/yaml.hpp"
+
+#include <chrono>
+#include <iostream>
+
+LOG_CHANNEL(cache_log, "CACHE");
+
+namespace rpcs3::cache
+{
+	// Rough peak memory use of one LLVM compilation thread (MiB)
+	static constexpr u64 memory_per_thread = 512;
+
+	static atomic_t<bool> s_running = false;
+
+	struct library_title
+	{
+		std::string serial;
+		std::string path;
+	};
+
+	// Same sources as the GUI game list: dev_hdd0/game, dev_hdd0/disc, games.yml, and VSH
+	static std::vector<library_title> get_library()
+	{
+		std::vector<std::string> paths;
+
+		const auto add_disc_dir = [&](const std::string& path)
+		{
+			for (const auto& entry : fs::dir(path))
+			{
+				if (entry.is_directory && (entry.name == "PS3_GAME" || (entry.name.starts_with("PS3_GM") && entry.name.size() == 8)))
+				{
+					paths.emplace_back(path + "/" + entry.name);
+				}
+			}
+		};
+
+		const auto add_dir = [&](const std::string& path, bool is_disc)
+		{
+			for (const auto& entry : fs::dir(path))
+			{
+				if (!entry.is_directory || entry.name == "." || entry.name == "..")
+				{
+					continue;
+				}
+
+				const std::string entry_path = path + entry.name;
+
+				if (fs::is_file(entry_path + "/PS3_DISC.SFB"))
+				{
+					if (is_disc)
+					{
+						add_disc_dir(entry_path);
+					}
+				}
+				else if (!is_disc)
+				{
+					paths.emplace_back(entry_path);
+				}
+			}
+		};
+
+		const std::string hdd0 = rpcs3::utils::get_hdd0_dir();
+
+		add_dir(hdd0 + "game/", false);
+		add_dir(hdd0 + "disc/", true);
+
+		if (const fs::file games{fs::get_config_dir() + "/games.yml"})
+		{
+			auto [result, error] = yaml_load(games.to_string());
+
+			if (!error.empty())
+			{
+				cache_log.error("Failed to load games.yml: %s", error);
+			}
+
+			for (auto&& pair : result)
+			{
+				std::string game_dir = pair.second.Scalar();
+				game_dir.resize(game_dir.find_last_not_of('/') + 1);
+
+				if (game_dir.empty())
+				{
+					continue;
+				}
+
+				if (fs::is_file(game_dir + "/PARAM.SFO"))
+				{
+					paths.emplace_back(game_dir);
+				}
+				else if (fs::is_file(game_dir + "/PS3_DISC.SFB"))
+				{
+					add_disc_dir(game_dir);
+				}
+			}
+		}
+
+		std::sort(paths.begin(), paths.end());
+		paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+		std::vector<library_title> titles;
+
+		if (const std::string vsh_path = g_cfg_vfs.get_dev_flash() + "vsh/module/"; fs::is_file(vsh_path + "vsh.self"))
+		{
+			titles.push_back({"", vsh_path});
+		}
+
+		for (auto& path : paths)
+		{
+			const psf::registry psf = psf::load_object(rpcs3::utils::get_sfo_dir_from_game_path(path) + "/PARAM.SFO");
+
+			if (const std::string_view serial = psf::get_string(psf, "TITLE_ID", ""); !serial.empty())
+			{
+				titles.push_back({std::string(serial), std::move(path)});
+			}
+		}
+
+		return titles;
+	}
+
+	struct cache_builder
+	{
+		builder_options options;
+
+		const std::string state_path = fs::get_cache_dir() + "cache_builder.yml";
+
+		// Titles already built (serial -> Version, Path, Seconds)
+		YAML::Node state;
+
+		static constexpr auto thread_name = "Cache Builder"sv;
+
+		void save_state() const
+		{
+			YAML::Emitter out;
+			out << state;
+
+			fs::pending_file temp(state_path);
+
+			if (!temp.file || temp.file.write(out.c_str(), out.size()), !temp.commit())
+			{
+				cache_log.error("Failed to save the progress to '%s' (%s)", state_path, fs::g_tls_error);
+			}
+		}
+
+		// Boot the title in the directory scan mode, which compiles every executable and exits
+		bool build(const library_title& title)
+		{
+			game_boot_result error = game_boot_result::generic_error;
+			atomic_t<bool> booted = false;
+
+			Emu.CallFromMainThread([&]()
+			{
+				Emu.GracefulShutdown(false);
+				Emu.SetForceBoot(true);
+				error = Emu.BootGame(title.path, title.serial, true);
+			}, &booted, false);
+
+			while (!booted)
+			{
+				thread_ctrl::wait_on(booted, false);
+			}
+
+			if (error != game_boot_result::no_errors)
+			{
+				cache_log.error("Could not boot '%s' (%s)", title.path, error);
+				return false;
+			}
+
+			while (!Emu.IsStopped())
+			{
+				thread_ctrl::wait_for(100'000);
+			}
+
+			return true;
+		}
+
+		void operator()()
+		{
+			if (const fs::file file{state_path}; file && !options.rebuild)
+			{
+				auto [result, error] = yaml_load(file.to_string());
+
+				if (!error.empty())
+				{
+					cache_log.error("Failed to load '%s', starting over: %s", state_path, error);
+				}
+				else if (result.IsMap())
+				{
+					state = result;
+				}
+			}
+
+			const std::string version = rpcs3::get_version_and_branch();
+			const auto titles = get_library();
+
+			std::cout << "Building caches for " << titles.size() << " title(s) with " << ::utils::get_job_budget() << " thread(s)" << std::endl;
+
+			u32 built = 0, skipped = 0, failed = 0;
+			const auto total_start = std::chrono::steady_clock::now();
+
+			for (usz i = 0; i < titles.size() && thread_ctrl::state() != thread_state::aborting; i++)
+			{
+				const library_title& title = titles[i];
+				const std::string key = title.serial.empty() ? "VSH" : title.serial;
+
+				if (const auto node = std::as_const(state)[key]; node && node["Version"] && node["Version"].Scalar() == version)
+				{
+					skipped++;
+					continue;
+				}
+
+				cache_log.notice("Building caches for %s ('%s')", key, title.path);
+
+				const auto start = std::chrono::steady_clock::now();
+
+				if (!build(title))
+				{
+					failed++;
+					std::cout << fmt::format("[%u/%u] %s: failed", i + 1, titles.size(), key) << std::endl;
+					continue;
+				}
+
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				// Remember the title as soon as it is done in case the run gets interrupted
+				state[key]["Path"] = title.path;
+				state[key]["Version"] = version;
+				state[key]["Seconds"] = fmt::format("%.1f", seconds);
+				save_state();
+
+				built++;
+				cache_log.success("Built caches for %s in %.1fs", key, seconds);
+				std::cout << fmt::format("[%u/%u] %s: %.1fs", i + 1, titles.size(), key, seconds) << std::endl;
+			}
+
+			const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - total_start).count();
+
+			cache_log.success("Cache building done in %.1fs: %u built, %u already built, %u failed", total, built, skipped, failed);
+			std::cout << fmt::format("Done in %.1fs: %u built, %u already built, %u failed", total, built, skipped, failed) << std::endl;
+
+			Emu.CallFromMainThread([]()
+			{
+				Emu.Quit(true);
+			}, nullptr, false);
+		}
+	};
+
+	bool is_builder_running()
+	{
+		return s_running;
+	}
+
+	void start_builder(const builder_options& options)
+	{
+		u32 threads = options.max_threads ? options.max_threads : ::utils::get_thread_count();
+
+		if (options.max_memory)
+		{
+			threads = std::min<u32>(threads, static_cast<u32>(std::max<u64>(options.max_memory / memory_per_thread, 1)));
+		}
+
+		// The job system runs all compilation, so its budget caps the whole process
+		::utils::set_job_budget(threads);
+
+		s_running = true;
+
+		static std::unique_ptr<named_thread<cache_builder>> s_builder;
+
+		s_builder = std::make_unique<named_thread<cache_builder>>(cache_builder{options});
+	}
+}
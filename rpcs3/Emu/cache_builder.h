@@ -0,0 +1,26 @@
+#pragma once
+
+#include "util/types.hpp"
+
+namespace rpcs3::cache
+{
+	struct builder_options
+	{
+		// Max amount of concurrent compilation threads (0 = all host threads)
+		u32 max_threads = 0;
+
+		// Memory the compilation threads may use in MiB (0 = unlimited)
+		u64 max_memory = 0;
+
+		// Build titles again even if a previous run already built them with this version
+		bool rebuild = false;
+	};
+
+	// Build the PPU caches of every title in the game library, one after another, then quit the emulator
+	// Progress is kept in the cache directory so an interrupted run continues where it stopped
+	// Works in the background: the main thread must keep processing events
+	void start_builder(const builder_options& options);
+
+	// Whether the emulator is driven by the cache builder
+	bool is_builder_running();
+}
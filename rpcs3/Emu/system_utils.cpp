@@ -65,6 +65,9 @@ namespace rpcs3::utils
 		}
 
 		was_silenced = silenced;
+
+		// Format messages on the log thread
+		logs::set_deferred(!silenced && g_cfg.misc.deferred_logging);
 	}
 
 	u32 check_user(const std::string& user)
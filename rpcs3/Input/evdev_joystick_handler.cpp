@@ -5,6 +5,7 @@
 
 #include "Input/product_info.h"
 #include "Emu/Io/pad_config.h"
+#include "Emu/Cell/timers.hpp"
 #include "evdev_joystick_handler.h"
 #include "util/logs.hpp"
 
@@ -12,6 +13,7 @@
 #include <algorithm>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/epoll.h>
 #include <errno.h>
 #include <cstring>
 #include <cstdio>
@@ -44,6 +46,11 @@ evdev_joystick_handler::evdev_joystick_handler()
 evdev_joystick_handler::~evdev_joystick_handler()
 {
 	close_devices();
+
+	if (m_epoll_fd != -1)
+	{
+		close(m_epoll_fd);
+	}
 }
 
 void evdev_joystick_handler::init_config(cfg_pad* cfg)
@@ -188,6 +195,9 @@ bool evdev_joystick_handler::update_device(const std::shared_ptr<PadDevice>& dev
 		return false;
 	}
 
+	// Event timestamps are compared with get_system_time for the input latency
+	libevdev_set_clock_id(dev, CLOCK_MONOTONIC);
+
 	evdev_log.notice("Opened joystick: '%s' at %s (fd %d)", get_device_name(dev), path, fd);
 	return true;
 }
@@ -782,6 +792,7 @@ std::shared_ptr<evdev_joystick_handler::EvdevDevice> evdev_joystick_handler::add
 				}
 
 				// Alright, now that we've confirmed we haven't added this joystick yet, les do dis.
+				libevdev_set_clock_id(dev, CLOCK_MONOTONIC);
 				m_dev->device     = dev;
 				m_dev->path       = path;
 				m_dev->has_rumble = libevdev_has_event_type(dev, EV_FF);
@@ -915,6 +926,11 @@ void evdev_joystick_handler::get_mapping(const pad_ensemble& binding)
 
 		if (ret == LIBEVDEV_READ_STATUS_SUCCESS)
 		{
+			if (evt.type != EV_SYN)
+			{
+				pad->m_input_timestamp.compare_and_swap(0, evt.input_event_sec * 1'000'000ull + evt.input_event_usec);
+			}
+
 			handle_input_event(evt, pad);
 		}
 	}
@@ -975,6 +991,92 @@ void evdev_joystick_handler::get_extended_info(const pad_ensemble& binding)
 	}
 }
 
+bool evdev_joystick_handler::wait_for_input(u64 timeout_us)
+{
+	if (m_epoll_fd == -1)
+	{
+		m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+		if (m_epoll_fd == -1)
+		{
+			evdev_log.error("epoll_create1 failed: %s [errno %d]", strerror(errno), errno);
+			return false;
+		}
+	}
+
+	std::unordered_map<int, const libevdev*> devices;
+
+	for (const auto& binding : m_bindings)
+	{
+		const auto evdev_device = static_cast<EvdevDevice*>(binding.device.get());
+
+		if (!binding.pad || !evdev_device || !evdev_device->device)
+		{
+			// process() only drains the buddy device of a connected pad, its level-triggered fd would stay ready forever
+			continue;
+		}
+
+		devices.emplace(libevdev_get_fd(evdev_device->device), evdev_device->device);
+
+		if (const auto buddy_device = static_cast<EvdevDevice*>(binding.buddy_device.get()); buddy_device && buddy_device->device)
+		{
+			devices.emplace(libevdev_get_fd(buddy_device->device), buddy_device->device);
+		}
+	}
+
+	// Sync the interest list, a closed fd drops out of it by itself but its number may have been reused
+	for (const auto& [fd, dev] : m_epoll_devices)
+	{
+		if (const auto found = devices.find(fd); found == devices.end() || found->second != dev)
+		{
+			epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+		}
+	}
+
+	for (const auto& [fd, dev] : devices)
+	{
+		if (const auto found = m_epoll_devices.find(fd); found == m_epoll_devices.end() || found->second != dev)
+		{
+			epoll_event event{};
+			event.events = EPOLLIN;
+			event.data.fd = fd;
+
+			if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1 && errno != EEXIST)
+			{
+				evdev_log.error("epoll_ctl failed for fd %d: %s [errno %d]", fd, strerror(errno), errno);
+			}
+		}
+	}
+
+	m_epoll_devices = std::move(devices);
+
+	if (m_epoll_devices.empty())
+	{
+		return false;
+	}
+
+	std::array<epoll_event, 8> events;
+
+	const int count = epoll_wait(m_epoll_fd, events.data(), ::size32(events), static_cast<int>(std::max<u64>(timeout_us / 1000, 1)));
+
+	if (count == -1 && errno != EINTR)
+	{
+		evdev_log.error("epoll_wait failed: %s [errno %d]", strerror(errno), errno);
+		return false;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (events[i].events & (EPOLLERR | EPOLLHUP))
+		{
+			// The device is going away, don't spin on it until the next connection check closes it
+			return false;
+		}
+	}
+
+	return true;
+}
+
 u16 evdev_joystick_handler::get_sensor_value(const libevdev* dev, const AnalogSensor& sensor, const input_event& evt) const
 {
 	if (dev)
@@ -385,6 +385,7 @@ public:
 	void get_motion_sensors(const std::string& padId, const motion_callback& callback, const motion_fail_callback& fail_callback, motion_preview_values preview_values, const std::array<AnalogSensor, 4>& sensors) override;
 	std::unordered_map<u32, std::string> get_motion_axis_list() const override;
 	void SetPadData(const std::string& padId, u8 player_id, u8 large_motor, u8 small_motor, s32 r, s32 g, s32 b, bool player_led, bool battery_led, u32 battery_led_brightness) override;
+	bool wait_for_input(u64 timeout_us) override;
 
 private:
 	void close_devices();
@@ -409,6 +410,10 @@ private:
 	bool m_is_button_or_trigger;
 	bool m_is_negative;
 
+	// epoll instance watching the bound devices, fds change when a device reconnects
+	int m_epoll_fd = -1;
+	std::unordered_map<int, const libevdev*> m_epoll_devices;
+
 	bool check_button(const EvdevButton& b, const u32 code);
 	bool check_buttons(const std::array<EvdevButton, 4>& b, const u32 code);
 
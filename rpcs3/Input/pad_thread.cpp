@@ -29,6 +29,9 @@ LOG_CHANNEL(sys_log, "SYS");
 
 extern bool is_input_allowed();
 
+// Longest time an event-driven handler blocks without input
+static constexpr u64 pad_event_timeout = 8'000;
+
 namespace pad
 {
 	atomic_t<pad_thread*> g_current = nullptr;
@@ -304,6 +307,11 @@ void pad_thread::operator()()
 					{
 						pad_sleep = std::max<u64>(pad_sleep, 30'000);
 					}
+					else if (g_cfg.io.pad_event_driven && handler->wait_for_input(pad_event_timeout))
+					{
+						// Process the new input as soon as it arrives, the timeout keeps connection checks and rumble going
+						continue;
+					}
 
 					thread_ctrl::wait_for(pad_sleep);
 				}
@@ -1,5 +1,6 @@
 #include "headless_application.h"
 
+#include "Emu/cache_builder.h"
 #include "Emu/RSX/Null/NullGSRender.h"
 #include "Emu/Cell/Modules/cellMsgDialog.h"
 #include "Emu/Cell/Modules/cellOskDialog.h"
@@ -75,6 +76,13 @@ void headless_application::InitializeCallbacks()
 		case video_renderer::opengl:
 		case video_renderer::vulkan:
 		{
+			if (rpcs3::cache::is_builder_running())
+			{
+				// Nothing is rendered while building caches, don't require the user config to be changed
+				g_fxo->init<rsx::thread, named_thread<NullGSRender>>(ar);
+				break;
+			}
+
 			fmt::throw_exception("Headless mode can only be used with the %s video renderer. Current renderer: %s", video_renderer::null, type);
 			[[fallthrough]];
 		}
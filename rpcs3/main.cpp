@@ -2,6 +2,7 @@
 // by Sacha Refshauge, Megamouse and flash-fire
 
 #include <iostream>
+#include <cstdlib>
 #include <chrono>
 #include <sstream>
 #include <iomanip>
@@ -68,6 +69,7 @@ DYNAMIC_IMPORT("ntdll.dll", NtSetTimerResolution, NTSTATUS(ULONG DesiredResoluti
 #include "rpcs3_version.h"
 #include "Emu/System.h"
 #include "Emu/system_utils.hpp"
+#include "Emu/cache_builder.h"
 #include <thread>
 #include <charconv>
 
@@ -290,6 +292,10 @@ constexpr auto arg_savestate    = "savestate";
 constexpr auto arg_timer        = "high-res-timer";
 constexpr auto arg_verbose_curl = "verbose-curl";
 constexpr auto arg_any_location = "allow-any-location";
+constexpr auto arg_build_caches = "build-caches";
+constexpr auto arg_cache_threads = "cache-threads";
+constexpr auto arg_cache_memory = "cache-memory";
+constexpr auto arg_rebuild_caches = "rebuild-caches";
 
 int find_arg(std::string arg, int& argc, char* argv[])
 {
@@ -304,7 +310,8 @@ QCoreApplication* create_application(int& argc, char* argv[])
 {
 	if (find_arg(arg_headless, argc, argv) != -1 ||
 		find_arg(arg_decrypt, argc, argv) != -1 ||
-		find_arg(arg_commit_db, argc, argv) != -1)
+		find_arg(arg_commit_db, argc, argv) != -1 ||
+		find_arg(arg_build_caches, argc, argv) != -1)
 	{
 		return new headless_application(argc, argv);
 	}
@@ -521,6 +528,9 @@ int main(int argc, char** argv)
 	static std::unique_ptr<logs::listener> fatal_listener = std::make_unique<fatal_error_listener>();
 	logs::listener::add(fatal_listener.get());
 
+	// Deliver deferred messages at exit, before the listeners above are destroyed
+	std::atexit(logs::shutdown);
+
 	{
 		// Write RPCS3 version
 		logs::stored_message ver{sys_log.always()};
@@ -647,6 +657,12 @@ int main(int argc, char** argv)
 	parser.addOption(QCommandLineOption(arg_timer, "Enable high resolution timer for better performance (windows)", "enabled", "1"));
 	parser.addOption(QCommandLineOption(arg_verbose_curl, "Enable verbose curl logging."));
 	parser.addOption(QCommandLineOption(arg_any_location, "Allow RPCS3 to be run from any location. Dangerous"));
+	parser.addOption(QCommandLineOption(arg_build_caches, "Build the PPU caches of the whole game library in headless mode, then exit."));
+	const QCommandLineOption cache_threads_option(arg_cache_threads, "Max amount of threads used by --build-caches.", "threads", "0");
+	parser.addOption(cache_threads_option);
+	const QCommandLineOption cache_memory_option(arg_cache_memory, "Memory budget of --build-caches in MiB.", "MiB", "0");
+	parser.addOption(cache_memory_option);
+	parser.addOption(QCommandLineOption(arg_rebuild_caches, "Make --build-caches ignore the progress of previous runs."));
 	parser.process(app->arguments());
 
 	// Don't start up the full rpcs3 gui if we just want the version or help.
@@ -1106,7 +1122,23 @@ int main(int argc, char** argv)
 		sys_log.notice("Option passed via command line: %s %s", opt.toStdString(), parser.value(opt).toStdString());
 	}
 
-	if (parser.isSet(arg_savestate))
+	if (parser.isSet(arg_build_caches))
+	{
+#ifdef _WIN32
+		// If launched from CMD
+		if (AttachConsole(ATTACH_PARENT_PROCESS))
+			[[maybe_unused]] const auto con_out = freopen("CONOUT$", "w", stdout);
+#endif
+		rpcs3::cache::builder_options options{};
+		options.max_threads = parser.value(cache_threads_option).toUInt();
+		options.max_memory = parser.value(cache_memory_option).toULongLong();
+		options.rebuild = parser.isSet(arg_rebuild_caches);
+
+		sys_log.notice("Building caches from command line (threads=%u, memory=%u MiB, rebuild=%d)", options.max_threads, options.max_memory, options.rebuild);
+
+		rpcs3::cache::start_builder(options);
+	}
+	else if (parser.isSet(arg_savestate))
 	{
 		const std::string savestate_path = parser.value(savestate_option).toStdString();
 		sys_log.notice("Booting savestate from command line: %s", savestate_path);
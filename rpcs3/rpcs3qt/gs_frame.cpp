@@ -484,6 +484,7 @@ void gs_frame::toggle_recording()
 		m_video_encoder->set_max_b_frames(g_cfg_recording.max_b_frames);
 		m_video_encoder->set_gop_size(g_cfg_recording.gop_size);
 		m_video_encoder->set_output_format(output_format);
+		m_video_encoder->set_thread_count(g_cfg_recording.encoder_threads);
 		m_video_encoder->set_sample_rate(0);   // TODO
 		m_video_encoder->set_audio_bitrate(0); // TODO
 		m_video_encoder->set_audio_codec(0);   // TODO
@@ -5,6 +5,7 @@
 #include "Utilities/mutex.h"
 
 #include <deque>
+#include <vector>
 #include <cmath>
 
 namespace utils
@@ -14,9 +15,30 @@ namespace utils
 	public:
 		image_sink() = default;
 
+		// Maximum amount of frames waiting to be consumed. New frames are dropped while the queue is full.
+		static constexpr usz frame_pool_size = 8;
+
 		virtual void stop(bool flush = true) = 0;
+
+		// Queues the frame if there is room for it. The vector is swapped with a recycled buffer, so producers should keep it around.
 		virtual void add_frame(std::vector<u8>& frame, const u32 width, const u32 height, s32 pixel_format, usz timestamp_ms) = 0;
 
+		bool can_add_frame()
+		{
+			reader_lock lock(m_mtx);
+			return m_frames_to_encode.size() < frame_pool_size;
+		}
+
+		void drop_frame()
+		{
+			m_dropped_frames++;
+		}
+
+		u64 get_dropped_frames() const
+		{
+			return m_dropped_frames;
+		}
+
 		s64 get_pts(usz timestamp_ms) const
 		{
 			return static_cast<s64>(std::round((timestamp_ms * m_framerate) / 1000.f));
@@ -44,9 +66,47 @@ namespace utils
 			std::vector<u8> data;
 		};
 
+		// Return the buffer of a consumed frame to the pool
+		void recycle_frame(encoder_frame&& frame)
+		{
+			if (frame.data.capacity() == 0)
+				return;
+
+			std::lock_guard lock(m_mtx);
+
+			if (m_free_buffers.size() < frame_pool_size)
+			{
+				m_free_buffers.push_back(std::move(frame.data));
+			}
+		}
+
 	protected:
+		// Requires m_mtx
+		bool queue_frame(std::vector<u8>& frame, const u32 width, const u32 height, s32 pixel_format, usz timestamp_ms)
+		{
+			if (m_frames_to_encode.size() >= frame_pool_size)
+			{
+				m_dropped_frames++;
+				return false;
+			}
+
+			std::vector<u8> data;
+
+			if (!m_free_buffers.empty())
+			{
+				data = std::move(m_free_buffers.back());
+				m_free_buffers.pop_back();
+			}
+
+			data.swap(frame);
+			m_frames_to_encode.emplace_back(timestamp_ms, width, height, pixel_format, std::move(data));
+			return true;
+		}
+
 		shared_mutex m_mtx;
 		std::deque<encoder_frame> m_frames_to_encode;
+		std::vector<std::vector<u8>> m_free_buffers;
+		atomic_t<u64> m_dropped_frames = 0;
 		atomic_t<bool> m_flush = false;
 		u32 m_framerate = 0;
 	};
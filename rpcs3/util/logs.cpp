@@ -3,6 +3,7 @@
 #include "Utilities/mutex.h"
 #include "Utilities/Thread.h"
 #include "Utilities/StrFmt.h"
+#include "util/asm.hpp"
 #include <cstring>
 #include <cstdarg>
 #include <string>
@@ -187,6 +188,351 @@ namespace logs
 	// Must be set to true in main()
 	static atomic_t<bool> g_init{false};
 
+	atomic_t<bool> g_deferred{false};
+
+	// Deferred message, followed by its arguments, thread prefix and preformatted text
+	struct deferred_record
+	{
+		u32 slots; // Record size in u64 units
+		u32 args;
+		u32 prefix_size;
+		u32 text_size;
+		const message* msg; // Null for padding at the end of the ring
+		u64 stamp;
+		const char* fmt; // Null if the text was formatted by the caller
+		const fmt_type_info* sup;
+	};
+
+	static_assert(sizeof(deferred_record) % sizeof(u64) == 0);
+
+	// Single producer (owner thread), single consumer (log thread) ring
+	struct deferred_ring
+	{
+		static constexpr u64 slot_count = 0x8000;
+
+		const std::unique_ptr<u64[]> data = std::make_unique<u64[]>(slot_count);
+
+		// Positions in slots, never wrapped
+		atomic_t<u64> head{0};
+		atomic_t<u64> tail{0};
+
+		// Set when the owner thread exits
+		atomic_t<bool> orphaned{false};
+
+		// Head after the record being written (owner thread only)
+		u64 reserved = 0;
+	};
+
+	class deferred_queue
+	{
+		std::thread m_thread{};
+		std::mutex m_mutex{};
+		std::vector<std::shared_ptr<deferred_ring>> m_rings{};
+		atomic_t<u32> m_signal{0};
+		atomic_t<bool> m_exit{false};
+
+		static thread_local inline bool s_tls_is_log_thread = false;
+
+		// Deliver all records queued so far, ordered by timestamp across threads
+		void drain()
+		{
+			std::vector<std::shared_ptr<deferred_ring>> rings;
+			{
+				std::lock_guard lock(m_mutex);
+				rings = m_rings;
+			}
+
+			std::vector<u64> ends(rings.size());
+
+			for (usz i = 0; i < rings.size(); i++)
+			{
+				ends[i] = rings[i]->head.load();
+			}
+
+			static constexpr fmt_type_info empty_sup{};
+
+			std::string prefix;
+			std::string text;
+
+			while (true)
+			{
+				deferred_ring* next = nullptr;
+				const deferred_record* next_rec = nullptr;
+
+				for (usz i = 0; i < rings.size(); i++)
+				{
+					deferred_ring& ring = *rings[i];
+
+					while (ring.tail < ends[i])
+					{
+						const auto rec = reinterpret_cast<const deferred_record*>(ring.data.get() + ring.tail % deferred_ring::slot_count);
+
+						if (!rec->msg)
+						{
+							// Skip padding
+							ring.tail += rec->slots;
+							continue;
+						}
+
+						if (!next_rec || rec->stamp < next_rec->stamp)
+						{
+							next = &ring;
+							next_rec = rec;
+						}
+
+						break;
+					}
+				}
+
+				if (!next)
+				{
+					break;
+				}
+
+				const u64* const args = reinterpret_cast<const u64*>(next_rec + 1);
+				const char* const chars = reinterpret_cast<const char*>(args + next_rec->args);
+
+				prefix.assign(chars, next_rec->prefix_size);
+
+				if (next_rec->fmt)
+				{
+					text.clear();
+					fmt::raw_append(text, next_rec->fmt, next_rec->sup ? next_rec->sup : &empty_sup, args);
+				}
+				else
+				{
+					text.assign(chars + next_rec->prefix_size, next_rec->text_size);
+				}
+
+				const message& msg = *next_rec->msg;
+				const u64 stamp = next_rec->stamp;
+				next->tail += next_rec->slots;
+
+				msg.deliver(stamp, prefix, text);
+			}
+
+			// Forget empty rings of finished threads
+			std::lock_guard lock(m_mutex);
+
+			std::erase_if(m_rings, [](const std::shared_ptr<deferred_ring>& ring)
+			{
+				return ring->orphaned && ring->tail == ring->head;
+			});
+		}
+
+	public:
+		deferred_queue()
+		{
+			m_thread = std::thread([this]()
+			{
+				s_tls_is_log_thread = true;
+
+				while (!m_exit)
+				{
+					const u32 signal = m_signal;
+					drain();
+					m_signal.wait(signal, atomic_wait_timeout{4'000'000});
+				}
+			});
+		}
+
+		~deferred_queue()
+		{
+			// Pending messages must have been delivered by stop(), listeners may already be gone here
+			m_exit = true;
+			wake();
+
+			if (m_thread.joinable())
+			{
+				m_thread.join();
+			}
+		}
+
+		// Deliver all pending messages and terminate the log thread
+		void stop()
+		{
+			if (!m_thread.joinable())
+			{
+				return;
+			}
+
+			g_deferred = false;
+			flush();
+			m_exit = true;
+			wake();
+			m_thread.join();
+		}
+
+		bool is_stopped() const
+		{
+			return !m_thread.joinable();
+		}
+
+		void wake()
+		{
+			m_signal++;
+			m_signal.notify_one();
+		}
+
+		// Wait until all messages queued before the call are delivered
+		void flush()
+		{
+			if (s_tls_is_log_thread)
+			{
+				return;
+			}
+
+			std::vector<std::pair<std::shared_ptr<deferred_ring>, u64>> pending;
+			{
+				std::lock_guard lock(m_mutex);
+
+				for (const auto& ring : m_rings)
+				{
+					pending.emplace_back(ring, ring->head.load());
+				}
+			}
+
+			wake();
+
+			for (const auto& [ring, end] : pending)
+			{
+				while (ring->tail < end)
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		// Returns the ring of the current thread
+		deferred_ring& get_ring()
+		{
+			struct ring_owner
+			{
+				std::shared_ptr<deferred_ring> ring;
+
+				~ring_owner()
+				{
+					if (ring)
+					{
+						ring->orphaned = true;
+					}
+				}
+			};
+
+			static thread_local ring_owner s_tls_ring;
+
+			if (!s_tls_ring.ring) [[unlikely]]
+			{
+				s_tls_ring.ring = std::make_shared<deferred_ring>();
+
+				std::lock_guard lock(m_mutex);
+				m_rings.emplace_back(s_tls_ring.ring);
+			}
+
+			return *s_tls_ring.ring;
+		}
+
+		// Reserve space for a record in the ring of the current thread, returns nullptr if it's too big
+		deferred_record* push(u32 args, u32 prefix_size, u32 text_size)
+		{
+			// Records are aligned to 64 bytes, which also leaves room for the padding header at the end of the ring
+			const u64 slots = utils::align<u64>(sizeof(deferred_record) + args * sizeof(u64) + prefix_size + text_size, 64) / sizeof(u64);
+
+			if (slots > deferred_ring::slot_count / 4 || s_tls_is_log_thread)
+			{
+				return nullptr;
+			}
+
+			deferred_ring& ring = get_ring();
+
+			const u64 head = ring.head;
+			const u64 pos = head % deferred_ring::slot_count;
+			const u64 padding = pos + slots > deferred_ring::slot_count ? deferred_ring::slot_count - pos : 0;
+
+			while (head + padding + slots - ring.tail > deferred_ring::slot_count)
+			{
+				// Ring full, wait for the log thread
+				wake();
+				std::this_thread::yield();
+			}
+
+			if (padding)
+			{
+				const auto pad = reinterpret_cast<deferred_record*>(ring.data.get() + pos);
+				pad->slots = static_cast<u32>(padding);
+				pad->msg = nullptr;
+			}
+
+			const auto rec = reinterpret_cast<deferred_record*>(ring.data.get() + (head + padding) % deferred_ring::slot_count);
+			rec->slots = static_cast<u32>(slots);
+			rec->args = args;
+			rec->prefix_size = prefix_size;
+			rec->text_size = text_size;
+			ring.reserved = head + padding + slots;
+
+			if (head + padding + slots - ring.tail > deferred_ring::slot_count / 4 && head - ring.tail <= deferred_ring::slot_count / 4)
+			{
+				// Crossing a quarter of the capacity, don't wait for the next polling
+				wake();
+			}
+
+			return rec;
+		}
+
+		// Publish the record returned by push()
+		void commit()
+		{
+			deferred_ring& ring = get_ring();
+			ring.head.release(ring.reserved);
+		}
+	};
+
+	static std::unique_ptr<deferred_queue>& get_deferred_queue()
+	{
+		static std::unique_ptr<deferred_queue> queue;
+		return queue;
+	}
+
+	void set_deferred(bool enabled)
+	{
+		auto& queue = get_deferred_queue();
+
+		if (enabled)
+		{
+			std::lock_guard lock(g_mutex);
+
+			if (!queue)
+			{
+				queue = std::make_unique<deferred_queue>();
+			}
+			else if (queue->is_stopped())
+			{
+				// Logging is shutting down
+				return;
+			}
+		}
+
+		if (g_deferred.exchange(enabled) && !enabled)
+		{
+			queue->flush();
+		}
+	}
+
+	void shutdown()
+	{
+		deferred_queue* queue = nullptr;
+		{
+			std::lock_guard lock(g_mutex);
+			queue = get_deferred_queue().get();
+		}
+
+		// The queue itself is only destroyed with the static storage
+		if (queue)
+		{
+			queue->stop();
+		}
+	}
+
 	void reset()
 	{
 		std::lock_guard lock(g_mutex);
@@ -336,6 +682,11 @@ void logs::listener::sync()
 
 void logs::listener::sync_all()
 {
+	if (g_deferred)
+	{
+		get_deferred_queue()->flush();
+	}
+
 	for (listener* lis = get_logger(); lis; lis = lis->m_next)
 	{
 		lis->sync();
@@ -378,6 +729,78 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) co
 	fmt::raw_append(text, fmt, sup ? sup : &empty_sup, args.data());
 	std::string prefix = g_tls_log_prefix();
 
+	if (g_deferred)
+	{
+		auto& queue = *get_deferred_queue();
+
+		if (*this > level::error)
+		{
+			// Keep the order with deferred messages of this thread
+			if (auto rec = queue.push(0, ::size32(prefix), ::size32(text)))
+			{
+				rec->msg = this;
+				rec->stamp = stamp;
+				rec->fmt = nullptr;
+				rec->sup = nullptr;
+
+				char* const chars = reinterpret_cast<char*>(rec + 1);
+				std::memcpy(chars, prefix.data(), prefix.size());
+				std::memcpy(chars + prefix.size(), text.data(), text.size());
+				queue.commit();
+
+				g_tls_log_control(fmt, -1);
+				return;
+			}
+		}
+
+		// Deliver pending messages before this one
+		queue.flush();
+	}
+
+	deliver(stamp, prefix, text);
+
+	// Notify end operation
+	g_tls_log_control(fmt, -1);
+}
+
+void logs::message::defer(const char* fmt, const fmt_type_info* sup, const u64* args, u32 count) const
+{
+	const u64 stamp = get_stamp();
+
+	g_tls_log_control(fmt, 0);
+
+	// The prefix depends on the state of the calling thread
+	std::string prefix = g_tls_log_prefix();
+
+	auto& queue = *get_deferred_queue();
+
+	if (auto rec = queue.push(count, ::size32(prefix), 0))
+	{
+		rec->msg = this;
+		rec->stamp = stamp;
+		rec->fmt = fmt;
+		rec->sup = sup;
+
+		u64* const data = reinterpret_cast<u64*>(rec + 1);
+		std::memcpy(data, args, count * sizeof(u64));
+		std::memcpy(data + count, prefix.data(), prefix.size());
+		queue.commit();
+	}
+	else
+	{
+		static constexpr fmt_type_info empty_sup{};
+
+		std::string text;
+		fmt::raw_append(text, fmt, sup ? sup : &empty_sup, args);
+		queue.flush();
+		deliver(stamp, prefix, text);
+	}
+
+	g_tls_log_control(fmt, -1);
+}
+
+void logs::message::deliver(u64 stamp, std::string& prefix, const std::string& text) const
+{
 	// Get first (main) listener
 	listener* lis = get_logger();
 
@@ -404,9 +827,6 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) co
 		lis->log(stamp, *this, prefix, text);
 		lis = lis->m_next;
 	}
-
-	// Notify end operation
-	g_tls_log_control(fmt, -1);
 }
 
 logs::file_writer::file_writer(const std::string& name, u64 max_size)
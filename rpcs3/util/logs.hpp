@@ -24,6 +24,14 @@ namespace logs
 
 	struct channel;
 
+	// Deferred mode: messages are queued per thread and formatted by the log thread (see set_deferred)
+	extern atomic_t<bool> g_deferred;
+
+	// Argument types which are passed to the formatter by value, so they can be formatted later
+	// Wider types (u128 and s128, which are arithmetic with GNU extensions) are unveiled as a pointer to the argument
+	template <typename T>
+	constexpr bool is_deferrable_v = (std::is_arithmetic_v<fmt_unveil_t<T>> || std::is_enum_v<fmt_unveil_t<T>>) && sizeof(fmt_unveil_t<T>) <= sizeof(u64) && alignof(fmt_unveil_t<T>) <= alignof(u64);
+
 	// Message information
 	struct message
 	{
@@ -55,7 +63,14 @@ namespace logs
 		// Send log message to global logger instance
 		void broadcast(const char*, const fmt_type_info*, ...) const;
 
+		// Queue log message for the log thread, format string must be static
+		void defer(const char*, const fmt_type_info*, const u64* args, u32 count) const;
+
+		// Send formatted log message to all listeners
+		void deliver(u64 stamp, std::string& prefix, const std::string& text) const;
+
 		friend struct channel;
+		friend class deferred_queue;
 	};
 
 	struct stored_message
@@ -141,6 +156,17 @@ namespace logs
 	{
 		if (operator bool()) [[unlikely]]
 		{
+			if constexpr ((is_deferrable_v<Args> && ...))
+			{
+				// Errors are always reported synchronously
+				if (g_deferred.observe() && *this > level::error)
+				{
+					const u64 data[sizeof...(Args) + 1]{u64{fmt_unveil<Args>::get(args)}...};
+					defer(fmt, fmt::type_info_v<Args...>, data, sizeof...(Args));
+					return;
+				}
+			}
+
 			if constexpr (sizeof...(Args) > 0)
 			{
 				broadcast(fmt, fmt::type_info_v<Args...>, u64{fmt_unveil<Args>::get(args)}...);
@@ -172,6 +198,12 @@ namespace logs
 	// Log level control: set specific channels to level::fatal
 	void set_channel_levels(const std::map<std::string, logs::level, std::less<>>& map);
 
+	// Enable or disable deferred mode, pending messages are flushed when disabled
+	void set_deferred(bool enabled);
+
+	// Flush and stop deferred logging, must be called before the listeners are destroyed
+	void shutdown();
+
 	// Get all registered log channels
 	std::vector<std::string> get_channels();
 
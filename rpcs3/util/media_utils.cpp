@@ -4,9 +4,13 @@
 #include "Utilities/StrUtil.h"
 #include "Emu/Cell/Modules/cellSearch.h"
 #include "Emu/System.h"
+#include "Utilities/job_system.h"
+#include "util/serialization.hpp"
 
 #include <random>
 
+#include "xxhash.h"
+
 #ifdef _MSC_VER
 #pragma warning(push, 0)
 #else
@@ -33,6 +37,9 @@ constexpr int averror_eof = AVERROR_EOF; // workaround for old-style-cast error
 
 LOG_CHANNEL(media_log, "Media");
 
+constexpr u64 media_index_magic = "RPCSMIDX"_u64;
+constexpr u32 media_index_version = 1;
+
 namespace utils
 {
 	template <>
@@ -176,6 +183,218 @@ namespace utils
 		return { true, std::move(info) };
 	}
 
+	void media_index::entry::operator()(utils::serial& ar)
+	{
+		ar(size, mtime, success, info.path, info.sub_type, info.audio_av_codec_id, info.video_av_codec_id, info.audio_bitrate_bps, info.video_bitrate_bps,
+			info.sample_rate, info.duration_us, info.width, info.height, info.orientation);
+
+		u32 count = ::size32(info.metadata);
+		ar(count);
+
+		if (ar.is_writing())
+		{
+			for (auto& [key, value] : info.metadata)
+			{
+				ar(key, value);
+			}
+
+			return;
+		}
+
+		for (u32 i = 0; i < count; i++)
+		{
+			std::string key = ar;
+			info.metadata[std::move(key)] = ar.operator std::string();
+		}
+	}
+
+	std::string media_index::get_path()
+	{
+		return fs::get_cache_dir() + "media_index.bin";
+	}
+
+	std::string media_index::get_key(const std::string& path, s32 av_media_type)
+	{
+		return fmt::format("%d:%s", av_media_type, path);
+	}
+
+	const media_index::entry* media_index::find(const std::string& key, const fs::stat_t& stat) const
+	{
+		const auto found = m_entries.find(key);
+
+		if (found == m_entries.cend() || found->second.size != stat.size || found->second.mtime != stat.mtime)
+		{
+			return nullptr;
+		}
+
+		return &found->second;
+	}
+
+	void media_index::prefetch(const std::vector<std::pair<std::string, fs::stat_t>>& files, s32 av_media_type)
+	{
+		load();
+
+		std::vector<u32> missing;
+		{
+			reader_lock lock(m_mutex);
+
+			for (u32 i = 0; i < files.size(); i++)
+			{
+				if (!find(get_key(files[i].first, av_media_type), files[i].second))
+				{
+					missing.push_back(i);
+				}
+			}
+		}
+
+		if (missing.empty())
+		{
+			return;
+		}
+
+		media_log.notice("Probing %u new or changed media files", missing.size());
+
+		run_jobs(job_class::foreground, ::size32(missing), [&](u32 index)
+		{
+			const auto& [path, stat] = files[missing[index]];
+			auto [success, info] = utils::get_media_info(path, av_media_type);
+
+			std::lock_guard lock(m_mutex);
+			m_entries.insert_or_assign(get_key(path, av_media_type), entry{stat.size, stat.mtime, success, std::move(info)});
+			m_dirty = true;
+		});
+	}
+
+	std::pair<bool, media_info> media_index::get_media_info(const std::string& path, const fs::stat_t& stat, s32 av_media_type)
+	{
+		load();
+
+		const std::string key = get_key(path, av_media_type);
+		{
+			reader_lock lock(m_mutex);
+
+			if (const entry* found = find(key, stat))
+			{
+				return { found->success, found->info };
+			}
+		}
+
+		auto [success, info] = utils::get_media_info(path, av_media_type);
+		{
+			std::lock_guard lock(m_mutex);
+			m_entries.insert_or_assign(key, entry{stat.size, stat.mtime, success, info});
+			m_dirty = true;
+		}
+
+		return { success, std::move(info) };
+	}
+
+	void media_index::flush()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+
+			if (!std::exchange(m_dirty, false))
+			{
+				return;
+			}
+		}
+
+		save();
+	}
+
+	void media_index::load()
+	{
+		if (m_loaded)
+		{
+			return;
+		}
+
+		std::lock_guard lock(m_mutex);
+
+		if (m_loaded)
+		{
+			return;
+		}
+
+		m_loaded = true;
+
+		const std::string path = get_path();
+		const fs::file file(path);
+
+		if (!file || file.size() < sizeof(u64) * 2)
+		{
+			return;
+		}
+
+		std::vector<u8> data = file.to_vector<u8>();
+
+		if (read_from_ptr<u64>(data) != media_index_magic || read_from_ptr<u64>(data, sizeof(u64)) != XXH64(data.data() + 16, data.size() - 16, 0))
+		{
+			media_log.warning("Ignoring invalid media index %s", path);
+			return;
+		}
+
+		data.erase(data.begin(), data.begin() + 16);
+
+		utils::serial ar;
+		ar.set_reading_state(std::move(data));
+
+		if (ar.operator u32() != media_index_version)
+		{
+			return;
+		}
+
+		usz pruned = 0;
+
+		for (u32 i = 0, count = ar; i < count; i++)
+		{
+			std::string key = ar;
+			entry e{};
+			ar(e);
+
+			// Forget the files which were removed or changed since they were probed
+			fs::stat_t stat{};
+
+			if (const usz pos = key.find(':'); pos == umax || !fs::stat(key.substr(pos + 1), stat) || stat.is_directory || stat.size != e.size || stat.mtime != e.mtime)
+			{
+				pruned++;
+				continue;
+			}
+
+			m_entries.emplace(std::move(key), std::move(e));
+		}
+
+		m_dirty = pruned != 0;
+
+		media_log.notice("Loaded %u entries from the media index (pruned %u)", m_entries.size(), pruned);
+	}
+
+	void media_index::save()
+	{
+		utils::serial ar;
+		{
+			reader_lock lock(m_mutex);
+
+			ar(media_index_magic, u64{0}, media_index_version, ::size32(m_entries));
+
+			for (auto& [key, e] : m_entries)
+			{
+				ar(key, e);
+			}
+		}
+
+		write_to_ptr<u64>(ar.data, sizeof(u64), XXH64(ar.data.data() + 16, ar.data.size() - 16, 0));
+
+		const std::string path = get_path();
+		fs::pending_file file(path);
+
+		if (!file.file || (file.file.write(ar.data), !file.commit()))
+		{
+			media_log.error("Failed to save media index %s (error=%s)", path, fs::g_tls_error);
+		}
+	}
+
 	struct scoped_av
 	{
 		AVFormatContext* format = nullptr;
@@ -233,13 +452,16 @@ namespace utils
 
 	void audio_decoder::clear()
 	{
+		std::lock_guard lock(m_mtx);
+
 		track_fully_decoded = false;
 		track_fully_consumed = false;
 		has_error = false;
 		m_size = 0;
 		duration_ms = 0;
-		timestamps_ms.clear();
-		data.clear();
+		m_seek_ms = u64{umax};
+		m_read_pos = 0;
+		m_timestamps_ms.clear();
 	}
 
 	void audio_decoder::stop()
@@ -248,8 +470,6 @@ namespace utils
 		{
 			auto& thread = *m_thread;
 			thread = thread_state::aborting;
-			track_fully_consumed = true;
-			track_fully_consumed.notify_one();
 			thread();
 			m_thread.reset();
 		}
@@ -257,15 +477,139 @@ namespace utils
 		clear();
 	}
 
+	u64 audio_decoder::read(void* dst, u64 size, u32& start_time_ms)
+	{
+		{
+			std::lock_guard lock(m_mtx);
+
+			size = std::min(size, m_size - m_read_pos);
+
+			if (size)
+			{
+				const u64 capacity = m_buffer.size();
+				const u64 offset = m_read_pos % capacity;
+				const u64 first = std::min(size, capacity - offset);
+
+				std::memcpy(dst, m_buffer.data() + offset, first);
+				std::memcpy(static_cast<u8*>(dst) + first, m_buffer.data(), size - first);
+
+				m_read_pos += size;
+			}
+
+			start_time_ms = 0;
+
+			if (!m_timestamps_ms.empty())
+			{
+				start_time_ms = static_cast<u32>(m_timestamps_ms.front().second);
+
+				while (m_timestamps_ms.size() > 1 && m_read_pos >= ::at32(m_timestamps_ms, 1).first)
+				{
+					m_timestamps_ms.pop_front();
+				}
+			}
+		}
+
+		if (size)
+		{
+			// Let the decoder refill the buffer
+			m_consumer_events++;
+			m_consumer_events.notify_one();
+		}
+
+		return size;
+	}
+
+	u64 audio_decoder::get_available_size()
+	{
+		reader_lock lock(m_mtx);
+		return m_size - m_read_pos;
+	}
+
+	void audio_decoder::seek(u64 timestamp_ms)
+	{
+		m_seek_ms = timestamp_ms;
+		m_consumer_events++;
+		m_consumer_events.notify_one();
+	}
+
+	void audio_decoder::finish_track()
+	{
+		// The decoder resets the buffer itself when it starts the next track
+		track_fully_consumed = true;
+		m_consumer_events++;
+		m_consumer_events.notify_one();
+	}
+
+	bool audio_decoder::write(const u8* src, u64 size, u32 timestamp_ms)
+	{
+		bool is_first_chunk = true;
+
+		while (size)
+		{
+			const u64 events = m_consumer_events;
+
+			if (thread_ctrl::state() == thread_state::aborting || m_seek_ms != umax)
+			{
+				return false;
+			}
+
+			{
+				std::lock_guard lock(m_mtx);
+
+				const u64 capacity = m_buffer.size();
+
+				if (const u64 space = capacity - (m_size - m_read_pos))
+				{
+					const u64 chunk = std::min(size, space);
+					const u64 offset = m_size % capacity;
+					const u64 first = std::min(chunk, capacity - offset);
+
+					if (is_first_chunk)
+					{
+						m_timestamps_ms.push_back({m_size, timestamp_ms});
+						is_first_chunk = false;
+					}
+
+					std::memcpy(m_buffer.data() + offset, src, first);
+					std::memcpy(m_buffer.data(), src + first, chunk - first);
+
+					m_size += chunk;
+					src += chunk;
+					size -= chunk;
+					continue;
+				}
+			}
+
+			// The buffer is full, wait until the consumer reads from it
+			thread_ctrl::wait_on(m_consumer_events, events);
+		}
+
+		return true;
+	}
+
 	void audio_decoder::decode()
 	{
 		stop();
 
+		// Interleaved stereo f32
+		m_buffer.resize(sample_rate * buffer_ms / 1000 * 2 * sizeof(f32));
+
 		media_log.notice("audio_decoder: %d entries in playlist. Start decoding...", m_context.playlist.size());
 
 		const auto decode_track = [this](const std::string& path)
 		{
 			media_log.notice("audio_decoder: decoding %s", path);
+
+			{
+				// Start the track with an empty buffer
+				std::lock_guard lock(m_mtx);
+				track_fully_decoded = false;
+				m_size = 0;
+				duration_ms = 0;
+				m_read_pos = 0;
+				m_timestamps_ms.clear();
+			}
+
 			scoped_av av;
 
 			// Get format from audio file
@@ -376,12 +720,60 @@ namespace utils
 			AVPacket* packet = av_packet_alloc();
 			std::unique_ptr<AVPacket, decltype([](AVPacket* p){av_packet_unref(p);})> packet_(packet);
 
-			// Iterate through frames
-			while (thread_ctrl::state() != thread_state::aborting && av_read_frame(av.format, packet) >= 0)
+			// Decode ahead of the consumer until the track ends or the buffer is full
+			while (thread_ctrl::state() != thread_state::aborting)
 			{
-				if (int err = avcodec_send_packet(av.context, packet); err < 0)
+				if (const u64 seek_ms = m_seek_ms.exchange(u64{umax}); seek_ms != umax)
+				{
+					const s64 timestamp = av_rescale_q(static_cast<s64>(seek_ms), AVRational{1, 1000}, stream->time_base);
+
+					if (int err = av_seek_frame(av.format, static_cast<int>(stream_index), timestamp, AVSEEK_FLAG_BACKWARD); err < 0)
+					{
+						media_log.error("audio_decoder: Failed to seek to %d ms: %d='%s'", seek_ms, err, av_error_to_string(err));
+					}
+					else
+					{
+						media_log.notice("audio_decoder: seeking to %d ms", seek_ms);
+						avcodec_flush_buffers(av.context);
+
+						// Drop the data decoded before the seek
+						std::lock_guard lock(m_mtx);
+						m_read_pos = m_size;
+						m_timestamps_ms.clear();
+						track_fully_decoded = false;
+					}
+				}
+
+				if (track_fully_decoded)
+				{
+					// Wait until the consumer finishes the track or seeks back into it
+					const u64 events = m_consumer_events;
+
+					if (track_fully_consumed)
+					{
+						return;
+					}
+
+					if (m_seek_ms == umax)
+					{
+						thread_ctrl::wait_on(m_consumer_events, events);
+					}
+
+					continue;
+				}
+
+				if (av_read_frame(av.format, packet) < 0)
 				{
-					media_log.error("audio_decoder: Queuing error: %d='%s'", err, av_error_to_string(err));
+					track_fully_decoded = true;
+					continue;
+				}
+
+				const int send_err = avcodec_send_packet(av.context, packet);
+				av_packet_unref(packet);
+
+				if (send_err < 0)
+				{
+					media_log.error("audio_decoder: Queuing error: %d='%s'", send_err, av_error_to_string(send_err));
 					has_error = true;
 					return;
 				}
@@ -419,38 +811,30 @@ namespace utils
 						return;
 					}
 
-					// Append resampled frames to data
+					if (m_swap_endianness)
 					{
-						std::scoped_lock lock(m_mtx);
-						data.resize(m_size + buffer_size);
-
-						if (m_swap_endianness)
+						// The format is float 32bit per channel.
+						for (usz i = 0; i + sizeof(f32) <= static_cast<usz>(buffer_size); i += sizeof(f32))
 						{
-							// The format is float 32bit per channel.
-							const auto write_byteswapped = [](const void* src, void* dst) -> void
-							{
-								*static_cast<f32*>(dst) = *static_cast<const be_t<f32>*>(src);
-							};
-
-							for (size_t i = 0; i < (buffer_size - sizeof(f32)); i += sizeof(f32))
-							{
-								write_byteswapped(buffer + i, data.data() + m_size + i);
-							}
-						}
-						else
-						{
-							memcpy(&data[m_size], buffer, buffer_size);
+							write_to_ptr<f32>(buffer, i, read_from_ptr<be_t<f32>>(buffer, i));
 						}
-
-						const u32 timestamp_ms = stream->time_base.den ? (1000 * av.frame->best_effort_timestamp * stream->time_base.num) / stream->time_base.den : 0;
-						timestamps_ms.push_back({m_size, timestamp_ms});
-						m_size += buffer_size;
 					}
 
+					const u32 timestamp_ms = stream->time_base.den ? (1000 * av.frame->best_effort_timestamp * stream->time_base.num) / stream->time_base.den : 0;
+
+					media_log.notice("audio_decoder: decoded frame_count=%d buffer_size=%d timestamp_us=%d", frame_count, buffer_size, av.frame->best_effort_timestamp);
+
+					// Append resampled frames to the buffer, this waits for the consumer
+					const bool written = write(buffer, buffer_size, timestamp_ms);
+
 					if (buffer)
 						av_free(buffer);
 
-					media_log.notice("audio_decoder: decoded frame_count=%d buffer_size=%d timestamp_us=%d", frame_count, buffer_size, av.frame->best_effort_timestamp);
+					if (!written)
+					{
+						// Aborted or seeking, the remaining frames of the packet are dropped
+						break;
+					}
 				}
 			}
 		};
@@ -484,8 +868,8 @@ namespace utils
 				ensure(m_context.current_track < m_context.playlist.size());
 				media_log.notice("audio_decoder: about to decode: %s (index=%d)", ::at32(m_context.playlist, m_context.current_track), m_context.current_track);
 
+				// Let's only decode one track at a time. Returns after the consumer finished reading the track.
 				decode_track(::at32(m_context.playlist, m_context.current_track));
-				track_fully_decoded = true;
 
 				if (has_error)
 				{
@@ -493,9 +877,6 @@ namespace utils
 					break;
 				}
 
-				// Let's only decode one track at a time. Wait for the consumer to finish reading the track.
-				media_log.notice("audio_decoder: waiting until track is consumed...");
-				thread_ctrl::wait_on(track_fully_consumed, false);
 				track_fully_consumed = false;
 			}
 
@@ -578,6 +959,11 @@ namespace utils
 		m_audio_codec_id = codec_id;
 	}
 
+	void video_encoder::set_thread_count(u32 thread_count)
+	{
+		m_thread_count = thread_count;
+	}
+
 	void video_encoder::add_frame(std::vector<u8>& frame, const u32 width, const u32 height, s32 pixel_format, usz timestamp_ms)
 	{
 		// Do not allow new frames while flushing
@@ -585,7 +971,7 @@ namespace utils
 			return;
 
 		std::lock_guard lock(m_mtx);
-		m_frames_to_encode.emplace_back(timestamp_ms, width, height, pixel_format, std::move(frame));
+		queue_frame(frame, width, height, pixel_format, timestamp_ms);
 	}
 
 	void video_encoder::pause(bool flush)
@@ -600,7 +986,7 @@ namespace utils
 				// Let's assume this will finish in a timely manner
 				while (m_flush && m_running)
 				{
-					std::this_thread::sleep_for(1us);
+					m_flush.wait(true);
 				}
 			}
 		}
@@ -619,7 +1005,7 @@ namespace utils
 				// Let's assume this will finish in a timely manner
 				while (m_flush && m_running)
 				{
-					std::this_thread::sleep_for(1ms);
+					m_flush.wait(true);
 				}
 			}
 
@@ -630,6 +1016,11 @@ namespace utils
 			m_thread.reset();
 		}
 
+		if (const u64 dropped = m_dropped_frames.exchange(0))
+		{
+			media_log.warning("video_encoder: %d frames were dropped because the encoder could not keep up", dropped);
+		}
+
 		std::lock_guard lock(m_mtx);
 		m_frames_to_encode.clear();
 		has_error = false;
@@ -672,8 +1063,9 @@ namespace utils
 			scoped_av av;
 			av.kill_callback = [this]()
 			{
-				m_flush = false;
 				m_running = false;
+				m_flush = false;
+				m_flush.notify_all();
 			};
 
 			const AVPixelFormat out_format = static_cast<AVPixelFormat>(m_out_format.av_pixel_format);
@@ -789,6 +1181,7 @@ namespace utils
 			media_log.notice("video_encoder: using framerate = %d", m_framerate);
 			media_log.notice("video_encoder: using gop_size = %d", m_gop_size);
 			media_log.notice("video_encoder: using max_b_frames = %d", m_max_b_frames);
+			media_log.notice("video_encoder: using threads = %d", m_thread_count);
 
 			av.context->codec_id = av.format->oformat->video_codec;
 			av.context->bit_rate = m_video_bitrate_bps;
@@ -799,6 +1192,7 @@ namespace utils
 			av.context->pix_fmt = out_format;
 			av.context->gop_size = m_gop_size;
 			av.context->max_b_frames = m_max_b_frames;
+			av.context->thread_count = static_cast<int>(m_thread_count);
 
 			if (av.format->oformat->flags & AVFMT_GLOBALHEADER)
 			{
@@ -897,6 +1291,16 @@ namespace utils
 
 			s64 last_pts = -1;
 
+			// Wraps the frame data for the conversion without copying it
+			std::unique_ptr<AVFrame, decltype([](AVFrame* f){ if (f) av_frame_free(&f); })> in_frame(av_frame_alloc());
+			frame_format sws_in_format{};
+
+			if (!in_frame)
+			{
+				media_log.error("video_encoder: av_frame_alloc failed");
+				has_error = true;
+			}
+
 			while ((thread_ctrl::state() != thread_state::aborting || m_flush) && !has_error)
 			{
 				encoder_frame frame_data;
@@ -910,6 +1314,7 @@ namespace utils
 						if (m_flush)
 						{
 							m_flush = false;
+							m_flush.notify_all();
 
 							if (!m_paused)
 							{
@@ -939,6 +1344,7 @@ namespace utils
 				if (pts <= last_pts)
 				{
 					media_log.notice("video_encoder: skipping frame. last_pts=%d, pts=%d", last_pts, pts);
+					recycle_frame(std::move(frame_data));
 					continue;
 				}
 
@@ -965,22 +1371,74 @@ namespace utils
 				}
 
 				// Update the context in case the frame format has changed
-				av.sws = sws_getCachedContext(av.sws, frame_data.width, frame_data.height, in_format,
-				                              av.context->width, av.context->height, out_format, SWS_BICUBIC, nullptr, nullptr, nullptr);
-				if (!av.sws)
+				if (!av.sws || sws_in_format.av_pixel_format != frame_data.av_pixel_format || sws_in_format.width != frame_data.width || sws_in_format.height != frame_data.height)
 				{
-					media_log.error("video_encoder: sws_getCachedContext failed");
-					has_error = true;
-					break;
+					if (av.sws)
+					{
+						sws_freeContext(av.sws);
+					}
+
+					if (!(av.sws = sws_alloc_context()))
+					{
+						media_log.error("video_encoder: sws_alloc_context failed");
+						has_error = true;
+						break;
+					}
+
+					av_opt_set_int(av.sws, "srcw", frame_data.width, 0);
+					av_opt_set_int(av.sws, "srch", frame_data.height, 0);
+					av_opt_set_int(av.sws, "src_format", in_format, 0);
+					av_opt_set_int(av.sws, "dstw", av.context->width, 0);
+					av_opt_set_int(av.sws, "dsth", av.context->height, 0);
+					av_opt_set_int(av.sws, "dst_format", out_format, 0);
+					av_opt_set_int(av.sws, "sws_flags", SWS_BICUBIC, 0);
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+					av_opt_set_int(av.sws, "threads", m_thread_count, 0);
+#endif
+
+					if (int err = sws_init_context(av.sws, nullptr, nullptr); err < 0)
+					{
+						media_log.error("video_encoder: sws_init_context failed. Error: %d='%s'", err, av_error_to_string(err));
+						sws_freeContext(av.sws);
+						av.sws = nullptr;
+						has_error = true;
+						break;
+					}
+
+					sws_in_format.av_pixel_format = frame_data.av_pixel_format;
+					sws_in_format.width = frame_data.width;
+					sws_in_format.height = frame_data.height;
 				}
 
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+				// Only the frame API splits the conversion across the context's threads
+				in_frame->format = in_format;
+				in_frame->width = static_cast<int>(frame_data.width);
+				in_frame->height = static_cast<int>(frame_data.height);
+				in_frame->buf[0] = av_buffer_create(frame_data.data.data(), frame_data.data.size(), [](void*, u8*){}, nullptr, AV_BUFFER_FLAG_READONLY);
+
+				for (int i = 0; i < 4; i++)
+				{
+					in_frame->data[i] = in_data[i];
+					in_frame->linesize[i] = in_line[i];
+				}
+
+				const int err = in_frame->buf[0] ? sws_scale_frame(av.sws, av.frame, in_frame.get()) : AVERROR(ENOMEM);
+				av_frame_unref(in_frame.get());
+
+				if (err < 0)
+#else
 				if (int err = sws_scale(av.sws, in_data, in_line, 0, frame_data.height, av.frame->data, av.frame->linesize); err < 0)
+#endif
 				{
 					media_log.error("video_encoder: sws_scale failed. Error: %d='%s'", err, av_error_to_string(err));
 					has_error = true;
 					break;
 				}
 
+				// The source data is not needed anymore
+				recycle_frame(std::move(frame_data));
+
 				av.frame->pts = pts;
 
 				if (int err = avcodec_send_frame(av.context, av.frame); err < 0)
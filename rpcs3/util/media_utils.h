@@ -5,6 +5,7 @@
 #include <deque>
 #include <mutex>
 #include <thread>
+#include "Utilities/File.h"
 #include "Utilities/StrUtil.h"
 #include "Utilities/Thread.h"
 #include "util/video_provider.h"
@@ -38,6 +39,46 @@ namespace utils
 
 	std::pair<bool, media_info> get_media_info(const std::string& path, s32 av_media_type);
 
+	struct serial;
+
+	// Persistent cache of get_media_info results, keyed by host path and media type
+	// Entries are only valid as long as the size and modification time of the file don't change
+	class media_index
+	{
+	public:
+		// Probe the files which are new or changed since the last probe in parallel
+		void prefetch(const std::vector<std::pair<std::string, fs::stat_t>>& files, s32 av_media_type);
+
+		// Get the media info of a file from the index, probing it if necessary
+		std::pair<bool, media_info> get_media_info(const std::string& path, const fs::stat_t& stat, s32 av_media_type);
+
+		// Save the index if it changed, called once a scan is complete
+		void flush();
+
+	private:
+		struct entry
+		{
+			u64 size = 0;
+			s64 mtime = 0;
+			bool success = false;
+			media_info info{};
+
+			void operator()(utils::serial& ar);
+		};
+
+		static std::string get_path();
+		static std::string get_key(const std::string& path, s32 av_media_type);
+
+		const entry* find(const std::string& key, const fs::stat_t& stat) const;
+		void load();
+		void save();
+
+		shared_mutex m_mutex;
+		std::unordered_map<std::string, entry> m_entries;
+		atomic_t<bool> m_loaded = false;
+		bool m_dirty = false;
+	};
+
 	template <typename D>
 	void parse_metadata(D& dst, const utils::media_info& mi, const std::string& key, const std::string& def, usz max_length)
 	{
@@ -62,17 +103,43 @@ namespace utils
 		void decode();
 		u32 set_next_index(bool next);
 
-		shared_mutex m_mtx;
+		// Copy up to size bytes of decoded PCM data and return the amount copied.
+		// start_time_ms receives the track time of the first copied byte.
+		u64 read(void* dst, u64 size, u32& start_time_ms);
+
+		// Decoded bytes of the current track that have not been read yet
+		u64 get_available_size();
+
+		// Drop the buffered data and continue decoding the current track at the given time
+		void seek(u64 timestamp_ms);
+
+		// Let the decoder continue with the next track of the playlist, the buffer is reset by the decoder thread
+		void finish_track();
+
 		const s32 sample_rate = 48000;
-		std::vector<u8> data;
-		atomic_t<u64> m_size = 0;
+
+		// Decoded data is streamed through a ring buffer of this length
+		static constexpr u64 buffer_ms = 2000;
+
+		atomic_t<u64> m_size = 0; // Bytes decoded from the current track
 		atomic_t<u64> duration_ms = 0;
 		atomic_t<bool> track_fully_decoded{false};
 		atomic_t<bool> track_fully_consumed{false};
 		atomic_t<bool> has_error{false};
-		std::deque<std::pair<u64, u64>> timestamps_ms;
 
 	private:
+		// Append decoded data, waiting for the consumer to make room. Returns false if the decoder has to stop.
+		bool write(const u8* src, u64 size, u32 timestamp_ms);
+
+		shared_mutex m_mtx;
+		std::vector<u8> m_buffer;
+		u64 m_read_pos = 0; // Bytes read from the current track
+		std::deque<std::pair<u64, u64>> m_timestamps_ms;
+
+		// Changed by the consumer to wake up the decoder
+		atomic_t<u64> m_consumer_events = 0;
+		atomic_t<u64> m_seek_ms = u64{umax};
+
 		bool m_swap_endianness = false;
 		music_selection_context m_context{};
 		std::unique_ptr<named_thread<std::function<void()>>> m_thread;
@@ -110,6 +177,7 @@ namespace utils
 		void set_sample_rate(u32 sample_rate);
 		void set_audio_bitrate(u32 bitrate);
 		void set_audio_codec(s32 codec_id);
+		void set_thread_count(u32 thread_count);
 		void add_frame(std::vector<u8>& frame, const u32 width, const u32 height, s32 pixel_format, usz timestamp_ms) override;
 		void pause(bool flush = true);
 		void stop(bool flush = true) override;
@@ -130,6 +198,7 @@ namespace utils
 		s32 m_max_b_frames = 2;
 		s32 m_gop_size = 12;
 		frame_format m_out_format{};
+		u32 m_thread_count = 0; // Colour conversion and encoding threads (0 = auto)
 
 		// Audio parameters
 		u32 m_sample_rate = 48000;
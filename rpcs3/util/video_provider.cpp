@@ -89,7 +89,23 @@ namespace utils
 
 		const usz timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - m_encoder_start).count() - m_pause_time_ms;
 		const s64 pts = m_image_sink->get_pts(timestamp_ms);
-		return pts > m_last_pts_incoming;
+
+		if (pts <= m_last_pts_incoming)
+			return false;
+
+		// Don't capture frames the sink has no room for. Count each skipped timestamp once.
+		if (!m_image_sink->can_add_frame())
+		{
+			if (pts > m_last_pts_dropped)
+			{
+				m_last_pts_dropped = pts;
+				m_image_sink->drop_frame();
+			}
+
+			return false;
+		}
+
+		return true;
 	}
 
 	void video_provider::present_frame(std::vector<u8>& data, const u32 width, const u32 height, bool is_bgra)
@@ -112,6 +128,7 @@ namespace utils
 		{
 			m_current_encoder_frame = 0;
 			m_last_pts_incoming = -1;
+			m_last_pts_dropped = -1;
 		}
 
 		if (m_current_encoder_frame == 0)
@@ -30,6 +30,7 @@ namespace utils
 		atomic_t<usz> m_current_encoder_frame{0};
 		steady_clock::time_point m_encoder_start{};
 		s64 m_last_pts_incoming = -1;
+		s64 m_last_pts_dropped = -1;
 		usz m_pause_time_ms = 0;
 	};
 